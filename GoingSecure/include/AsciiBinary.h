@@ -1,5 +1,6 @@
 #pragma once
 #include "Prerequisites.h"
+#include "Simd.h"
 
 /**
  * @class AsciiBinary
@@ -28,8 +29,7 @@ public:
     /**
      * @brief Convierte un carcter a una cadena binaria de 8 bits.
      *
-     * Usa aritmtica binaria para calcular cada bit y formatear
-     * el resultado como cadena de texto compuesta por '0' y '1'.
+     * Toma los 8 caracteres '0'/'1' de una tabla precalculada de 256 entradas.
      *
      * @param c Carcter ASCII a convertir.
      * @return std::string Cadena binaria de 8 caracteres.
@@ -38,20 +38,45 @@ public:
      * en memoria, til en herramientas tipo debugger o consola de depuracin.
      */
     std::string bitset(char c) {
-        std::string result(8, '0');
-        int value = static_cast<unsigned char>(c);
-        for (int i = 7; i >= 0; --i) {
-            result[i] = (value % 2) + '0';
-            value /= 2;
+        return std::string(bitsTable().chars[static_cast<unsigned char>(c)], 8);
+    }
+
+    /**
+     * @brief Longitud exacta de stringToBinary() para n bytes: 8 bits y un espacio
+     * por byte, sin espacio final (9n - 1).
+     */
+    static size_t binaryLength(size_t n) {
+        return n == 0 ? 0 : 9 * n - 1;
+    }
+
+    /**
+     * @brief Escribe la representacin binaria de n bytes en un bfer del llamador.
+     *
+     * Cada byte copia sus 8 caracteres de la tabla con una sola escritura de 8 bytes;
+     * no hay divisiones ni flujos intermedios.
+     *
+     * @param input Bytes de entrada.
+     * @param n Nmero de bytes.
+     * @param output Destino de al menos binaryLength(n) caracteres (sin terminador).
+     * @return size_t Caracteres escritos.
+     */
+    size_t stringToBinary(const uint8_t* input, size_t n, char* output) {
+        if (n == 0) return 0;
+        const BitsTable& table = bitsTable();
+        char* o = output;
+        for (size_t i = 0; i + 1 < n; ++i, o += 9) {
+            std::memcpy(o, table.chars[input[i]], 8);
+            o[8] = ' ';
         }
-        return result;
+        std::memcpy(o, table.chars[input[n - 1]], 8);
+        return binaryLength(n);
     }
 
     /**
      * @brief Convierte una cadena ASCII a su representacin binaria.
      *
-     * Aplica la conversin binaria carcter por carcter utilizando el
-     * mtodo `bitset()` y concatena los resultados separados por espacios.
+     * Reserva la salida con su tamao exacto y la escribe directamente con
+     * stringToBinary(input, n, output).
      *
      * @param input Cadena ASCII de entrada.
      * @return std::string Texto binario con grupos de 8 bits separados por espacios.
@@ -59,16 +84,10 @@ public:
      * @note Puede utilizarse para mostrar cmo se codifican mensajes en protocolos de red o archivos binarios.
      */
     std::string stringToBinary(const std::string& input) {
-        std::ostringstream oss;
-        for (char c : input) {
-            oss << bitset(c) << " ";
-        }
-
-        std::string output = oss.str();
-        if (!output.empty()) {
-            output.pop_back();  // Eliminar espacio final
+        std::string output(binaryLength(input.size()), '\0');
+        if (!input.empty()) {
+            stringToBinary(reinterpret_cast<const uint8_t*>(input.data()), input.size(), &output[0]);
         }
-
         return output;
     }
 
@@ -92,11 +111,96 @@ public:
         return static_cast<char>(value);
     }
 
+    /**
+     * @brief Resultado de binaryToBytes().
+     */
+    struct ParseResult {
+        size_t bytes = 0;                       ///< Bytes escritos.
+        size_t errors = 0;                      ///< Fragmentos mal formados descartados.
+        size_t firstError = std::string::npos;  ///< Posicin del primero (npos si no hay).
+    };
+
+    /**
+     * @brief Bytes mximos que puede escribir binaryToBytes() con n caracteres.
+     */
+    static size_t maxBytes(size_t n) {
+        return n / 8;
+    }
+
+    /**
+     * @brief Convierte texto de '0'/'1' en bytes, en un bfer del llamador.
+     *
+     * Acepta grupos de 8 bits separados por espacios, tabuladores o saltos de lnea,
+     * o pegados ("0100000101000010" son dos bytes). Cada tramo de dgitos debe tener
+     * un mltiplo de 8; si no, se descarta entero y se informa su posicin. Cualquier
+     * otro carcter tambin se informa y se ignora.
+     *
+     * Con SSE2 se compara un bloque de 16 caracteres contra '0' y '1' y movemask
+     * rene los bits; cada grupo de 8 se convierte en un byte sin bucle por bit.
+     *
+     * @param input Texto binario.
+     * @param n Nmero de caracteres.
+     * @param output Destino de al menos maxBytes(n) bytes.
+     * @param errorPositions Si no es nulo, recibe la posicin de cada error.
+     * @return ParseResult Bytes escritos y errores encontrados.
+     */
+    ParseResult binaryToBytes(const char* input, size_t n, uint8_t* output,
+        std::vector<size_t>* errorPositions = nullptr) {
+        ParseResult result;
+        const BitReverseTable& reverse = bitReverseTable();
+        size_t pos = 0;
+        size_t runStart = std::string::npos;    // Inicio del tramo de dgitos en curso.
+        size_t runBytes = 0;                    // Bytes escritos antes de ese tramo.
+
+        while (pos < n) {
+            const size_t avail = n - pos < 16 ? n - pos : 16;
+            uint32_t digits;
+            uint32_t ones;
+            classify(input + pos, avail, digits, ones);
+
+            // Dgitos consecutivos desde pos (como mucho avail).
+            const size_t run = static_cast<size_t>(gsCountTrailingZeros64(~static_cast<uint64_t>(digits)));
+            if (run >= 8) {
+                if (runStart == std::string::npos) {
+                    runStart = pos;
+                    runBytes = result.bytes;
+                }
+                output[result.bytes++] = reverse.value[ones & 0xFF];
+                if (run >= 16) {
+                    output[result.bytes++] = reverse.value[(ones >> 8) & 0xFF];
+                    pos += 16;
+                }
+                else {
+                    pos += 8;
+                }
+                continue;
+            }
+
+            if (run > 0) {
+                // El tramo termina con un grupo incompleto: se descarta entero.
+                const size_t at = runStart != std::string::npos ? runStart : pos;
+                reportError(at, result, errorPositions);
+                result.bytes = runStart != std::string::npos ? runBytes : result.bytes;
+                runStart = std::string::npos;
+                pos += run;
+                continue;
+            }
+
+            runStart = std::string::npos;
+            const char c = input[pos];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                reportError(pos, result, errorPositions);
+            }
+            ++pos;
+        }
+        return result;
+    }
+
     /**
      * @brief Convierte una secuencia binaria a texto ASCII.
      *
-     * Divide la entrada en fragmentos de 8 bits, convierte cada uno
-     * en carcter ASCII, y los concatena para reconstruir el texto original.
+     * Usa binaryToBytes(): grupos de 8 bits separados por espacios o pegados; los
+     * fragmentos mal formados se descartan.
      *
      * @param binaryInput Cadena de bits separados por espacio.
      * @return std::string Texto decodificado en ASCII.
@@ -105,17 +209,92 @@ public:
      * terminales en interfaces tipo sci-fi o para ensear codificacin binaria.
      */
     std::string binaryToString(const std::string& binaryInput) {
-        std::istringstream iss(binaryInput);
-        std::string result;
-        std::string binary;
-
-        while (iss >> binary) {
-            result += binaryToChar(binary);
-        }
-
+        std::string result(maxBytes(binaryInput.size()), '\0');
+        if (result.empty()) return result;
+        ParseResult parsed = binaryToBytes(binaryInput.data(), binaryInput.size(),
+            reinterpret_cast<uint8_t*>(&result[0]));
+        result.resize(parsed.bytes);
         return result;
     }
 
 private:
     // Esta clase no requiere atributos privados persistentes.
+
+    /**
+     * @brief Los 8 caracteres '0'/'1' de cada byte, del bit ms significativo al menor.
+     */
+    struct BitsTable {
+        char chars[256][8];
+    };
+
+    static constexpr BitsTable makeBitsTable() {
+        BitsTable table{};
+        for (int value = 0; value < 256; ++value) {
+            for (int bit = 0; bit < 8; ++bit) {
+                table.chars[value][bit] = static_cast<char>('0' + ((value >> (7 - bit)) & 1));
+            }
+        }
+        return table;
+    }
+
+    static const BitsTable& bitsTable() {
+        static constexpr BitsTable table = makeBitsTable();
+        return table;
+    }
+
+    /**
+     * @brief Byte con los bits en orden inverso: movemask deja el primer carcter en
+     * el bit 0 y en el texto va primero el bit ms significativo.
+     */
+    struct BitReverseTable {
+        uint8_t value[256];
+    };
+
+    static constexpr BitReverseTable makeBitReverseTable() {
+        BitReverseTable table{};
+        for (int value = 0; value < 256; ++value) {
+            int reversed = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (value & (1 << bit)) reversed |= 0x80 >> bit;
+            }
+            table.value[value] = static_cast<uint8_t>(reversed);
+        }
+        return table;
+    }
+
+    static const BitReverseTable& bitReverseTable() {
+        static constexpr BitReverseTable table = makeBitReverseTable();
+        return table;
+    }
+
+    /**
+     * @brief Mscaras de los hasta 16 caracteres desde p: bit i de digits si el
+     * carcter i es '0' o '1', bit i de ones si es '1'.
+     */
+    static void classify(const char* p, size_t avail, uint32_t& digits, uint32_t& ones) {
+#if defined(GS_HAS_SSE2)
+        if (avail == 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i isOne = _mm_cmpeq_epi8(v, _mm_set1_epi8('1'));
+            const __m128i isZero = _mm_cmpeq_epi8(v, _mm_set1_epi8('0'));
+            digits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(isOne, isZero)));
+            ones = static_cast<uint32_t>(_mm_movemask_epi8(isOne));
+            return;
+        }
+#endif
+        digits = 0;
+        ones = 0;
+        for (size_t i = 0; i < avail; ++i) {
+            if (p[i] == '0') digits |= 1u << i;
+            else if (p[i] == '1') {
+                digits |= 1u << i;
+                ones |= 1u << i;
+            }
+        }
+    }
+
+    static void reportError(size_t position, ParseResult& result, std::vector<size_t>* positions) {
+        if (result.errors++ == 0) result.firstError = position;
+        if (positions != nullptr) positions->push_back(position);
+    }
 };
@@ -0,0 +1,497 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Simd.h"
+
+/**
+ * @class Base64
+ * @brief Codificador/decodificador Base64 estándar (RFC 4648), sin estado ni bloqueos.
+ *
+ * - La tabla de decodificación se construye en tiempo de compilación.
+ * - La salida se reserva con su tamaño exacto antes de escribirla.
+ * - Si la CPU tiene AVX2, codifica 24 bytes y decodifica 32 caracteres por iteración; el resto
+ *   (final del texto, relleno, espacios) lo procesa el camino escalar.
+ *
+ * Modos de decodificación:
+ * - Strict: solo el alfabeto, longitud múltiplo de 4, relleno '=' únicamente al
+ *   final y bits sobrantes del último bloque a cero (forma canónica).
+ * - IgnoreWhitespace: además acepta espacios, tabuladores y saltos de línea en
+ *   cualquier posición (p. ej. Base64 partido en líneas de 76 caracteres).
+ */
+class Base64 {
+public:
+    enum class Mode {
+        Strict,
+        IgnoreWhitespace
+    };
+
+    /**
+     * @brief Caracteres que produce encode() para n bytes.
+     */
+    static size_t encodedLength(size_t n) {
+        return (n + 2) / 3 * 4;
+    }
+
+    /**
+     * @brief Codifica n bytes en out (que debe tener encodedLength(n) caracteres).
+     * @return size_t Caracteres escritos.
+     */
+    static size_t encode(const uint8_t* in, size_t n, char* out) {
+        static const char alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+            "abcdefghijklmnopqrstuvwxyz"
+            "0123456789+/";
+        size_t i = 0;
+        char* o = out;
+
+#if defined(GS_HAS_AVX2)
+        if (gsCpuHasAvx2()) {
+            i = encodeAvx2(in, n, o);
+            o += i / 3 * 4;
+        }
+#endif
+        for (; i + 3 <= n; i += 3, o += 4) {
+            uint32_t block = (static_cast<uint32_t>(in[i]) << 16) |
+                (static_cast<uint32_t>(in[i + 1]) << 8) | in[i + 2];
+            o[0] = alphabet[(block >> 18) & 0x3F];
+            o[1] = alphabet[(block >> 12) & 0x3F];
+            o[2] = alphabet[(block >> 6) & 0x3F];
+            o[3] = alphabet[block & 0x3F];
+        }
+        if (i < n) {
+            uint32_t block = static_cast<uint32_t>(in[i]) << 16;
+            if (i + 1 < n) block |= static_cast<uint32_t>(in[i + 1]) << 8;
+            o[0] = alphabet[(block >> 18) & 0x3F];
+            o[1] = alphabet[(block >> 12) & 0x3F];
+            o[2] = i + 1 < n ? alphabet[(block >> 6) & 0x3F] : '=';
+            o[3] = '=';
+            o += 4;
+        }
+        return static_cast<size_t>(o - out);
+    }
+
+    static std::string encode(const uint8_t* in, size_t n) {
+        std::string out(encodedLength(n), '\0');
+        if (n > 0) encode(in, n, &out[0]);
+        return out;
+    }
+
+    static std::string encode(const std::vector<uint8_t>& data) {
+        return encode(data.data(), data.size());
+    }
+
+    /**
+     * @brief Cota superior de los bytes decodificados de n caracteres (exacta en
+     * modo Strict si se pasa también el texto, ver decodedLength(in, n)).
+     */
+    static size_t maxDecodedLength(size_t n) {
+        return n / 4 * 3;
+    }
+
+    /**
+     * @brief Bytes exactos que produce un texto Base64 estricto (sin espacios).
+     */
+    static size_t decodedLength(const char* in, size_t n) {
+        size_t pad = 0;
+        if (n >= 1 && in[n - 1] == '=') pad++;
+        if (n >= 2 && in[n - 2] == '=') pad++;
+        return n % 4 == 0 ? n / 4 * 3 - pad : maxDecodedLength(n);
+    }
+
+    /**
+     * @brief Estado de una decodificación por trozos: el cuanto incompleto (hasta 3
+     * caracteres ya convertidos a 6 bits) y si ya apareció el relleno final.
+     */
+    struct DecodeState {
+        uint32_t block = 0;         ///< Bits acumulados del cuanto actual.
+        unsigned int symbols = 0;   ///< Caracteres del cuanto actual (incluido el relleno).
+        unsigned int padding = 0;   ///< '=' del cuanto actual.
+        bool finished = false;      ///< Ya se leyó un cuanto con relleno.
+    };
+
+    /**
+     * @brief Decodifica n caracteres en out (al menos maxDecodedLength(n) bytes).
+     *
+     * @return size_t Bytes escritos.
+     * @throws std::runtime_error Si el texto no es Base64 válido en el modo pedido.
+     */
+    static size_t decode(const char* in, size_t n, uint8_t* out, Mode mode = Mode::Strict) {
+        DecodeState state;
+        const size_t written = decodeChunk(in, n, out, mode, state);
+        if (state.symbols != 0) throw invalid();
+        return written;
+    }
+
+    /**
+     * @brief Decodifica un trozo continuando el estado de los trozos anteriores.
+     *
+     * Los caracteres de un cuanto incompleto quedan en `state` para el trozo
+     * siguiente. out debe tener al menos maxDecodedLength(n + 3) bytes.
+     *
+     * @return size_t Bytes escritos.
+     * @throws std::runtime_error Si el texto no es Base64 válido en el modo pedido.
+     */
+    static size_t decodeChunk(const char* in, size_t n, uint8_t* out, Mode mode, DecodeState& state) {
+        const DecodeTable& table = decodeTable();
+        size_t i = 0;
+        uint8_t* o = out;
+        uint32_t block = state.block;
+        unsigned int symbols = state.symbols;
+        unsigned int padding = state.padding;
+        bool finished = state.finished;
+#if defined(GS_HAS_AVX2)
+        const bool avx2 = gsCpuHasAvx2();
+#endif
+
+        while (i < n) {
+#if defined(GS_HAS_AVX2)
+            // Entre cuantos completos, intenta bloques de 32 caracteres sin relleno ni espacios.
+            if (symbols == 0 && !finished && avx2) {
+                const size_t consumed = decodeAvx2(in + i, n - i, o);
+                i += consumed;
+                o += consumed / 4 * 3;
+            }
+#endif
+            const uint8_t value = table.value[static_cast<unsigned char>(in[i++])];
+            if (value < 64) {
+                if (padding > 0 || finished) throw invalid();
+                block = (block << 6) | value;
+            }
+            else if (value == kPadding) {
+                // Relleno solo en las posiciones 3 y 4 de un cuanto.
+                if (symbols < 2 || finished) throw invalid();
+                block <<= 6;
+                padding++;
+            }
+            else if (value == kWhitespace && mode == Mode::IgnoreWhitespace) {
+                continue;
+            }
+            else {
+                throw invalid();
+            }
+
+            if (++symbols == 4) {
+                *o++ = static_cast<uint8_t>(block >> 16);
+                if (padding < 2) *o++ = static_cast<uint8_t>(block >> 8);
+                if (padding < 1) *o++ = static_cast<uint8_t>(block);
+                if (padding > 0) {
+                    // Forma canónica: los bits que no forman un byte deben ser cero.
+                    const uint32_t unused = padding == 2 ? 0xFFFFu : 0xFFu;
+                    if (mode == Mode::Strict && (block & unused) != 0) throw invalid();
+                    finished = true;
+                }
+                symbols = 0;
+                block = 0;
+                padding = 0;
+            }
+        }
+
+        state.block = block;
+        state.symbols = symbols;
+        state.padding = padding;
+        state.finished = finished;
+        return static_cast<size_t>(o - out);
+    }
+
+    static std::vector<uint8_t> decode(const char* in, size_t n, Mode mode = Mode::Strict) {
+        std::vector<uint8_t> out(mode == Mode::Strict ? decodedLength(in, n) : maxDecodedLength(n));
+        // Strict con longitud válida ya es exacto; en otro caso se recorta (sin realojar).
+        const size_t written = decode(in, n, out.data(), mode);
+        out.resize(written);
+        return out;
+    }
+
+    static std::vector<uint8_t> decode(const std::string& text, Mode mode = Mode::Strict) {
+        return decode(text.data(), text.size(), mode);
+    }
+
+private:
+    static const uint8_t kInvalid = 0xFF;
+    static const uint8_t kWhitespace = 0xFE;
+    static const uint8_t kPadding = 0xFD;
+
+    /**
+     * @brief Valor de 6 bits de cada carácter, o kInvalid / kWhitespace / kPadding.
+     */
+    struct DecodeTable {
+        uint8_t value[256];
+    };
+
+    static constexpr DecodeTable makeDecodeTable() {
+        DecodeTable table{};
+        for (int c = 0; c < 256; ++c) table.value[c] = kInvalid;
+        for (int c = 0; c < 26; ++c) {
+            table.value['A' + c] = static_cast<uint8_t>(c);
+            table.value['a' + c] = static_cast<uint8_t>(26 + c);
+        }
+        for (int c = 0; c < 10; ++c) table.value['0' + c] = static_cast<uint8_t>(52 + c);
+        table.value['+'] = 62;
+        table.value['/'] = 63;
+        table.value['='] = kPadding;
+        table.value[' '] = kWhitespace;
+        table.value['\t'] = kWhitespace;
+        table.value['\r'] = kWhitespace;
+        table.value['\n'] = kWhitespace;
+        return table;
+    }
+
+    static const DecodeTable& decodeTable() {
+        static constexpr DecodeTable table = makeDecodeTable();
+        return table;
+    }
+
+    static std::runtime_error invalid() {
+        return std::runtime_error("Cadena Base64 inválida.");
+    }
+
+#if defined(GS_HAS_AVX2)
+    /**
+     * @brief Bloques de 24 bytes -> 32 caracteres (cada bloque lee 28 bytes de entrada).
+     *
+     * Cada carril de 128 bits recibe 12 bytes; pshufb los coloca como [b1 b0 b2 b1]
+     * por palabra, las multiplicaciones separan los cuatro índices de 6 bits y una
+     * tabla de 16 entradas suma el desplazamiento ASCII de cada rango.
+     *
+     * @return size_t Bytes codificados (múltiplo de 24).
+     */
+    GS_TARGET_AVX2 static size_t encodeAvx2(const uint8_t* in, size_t n, char* out) {
+        size_t i = 0;
+        for (; i + 28 <= n; i += 24, out += 32) {
+            encodeBlockAvx2(in + i, out);
+        }
+        return i;
+    }
+
+    /**
+     * @brief 24 bytes -> 32 caracteres (lee 28 bytes de entrada).
+     */
+    GS_TARGET_AVX2 static void encodeBlockAvx2(const uint8_t* in, char* out) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12));
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+        v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+        const __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0FC0FC00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003F03F0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        // 0..25 -> 'A', 26..51 -> 'a', 52..61 -> '0', 62 -> '+', 63 -> '/'.
+        const __m256i offsets = _mm256_setr_epi8(
+            65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+            65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        range = _mm256_sub_epi8(range, _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)));
+        const __m256i chars = _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), chars);
+    }
+
+    /**
+     * @brief Decodifica bloques de 32 caracteres del alfabeto mientras queden al
+     * menos 48 en la entrada; se detiene en el primer bloque con otro carácter.
+     *
+     * @return size_t Caracteres consumidos (múltiplo de 32).
+     */
+    GS_TARGET_AVX2 static size_t decodeAvx2(const char* in, size_t n, uint8_t* out) {
+        size_t i = 0;
+        while (i + 48 <= n && decodeBlockAvx2(in + i, out)) {
+            i += 32;
+            out += 24;
+        }
+        return i;
+    }
+
+    /**
+     * @brief 32 caracteres -> 24 bytes (escribe 32 bytes en out).
+     *
+     * Valida los 32 caracteres con dos tablas indexadas por nibble; si alguno no es
+     * del alfabeto (relleno, espacio o inválido) devuelve false sin consumir nada.
+     */
+    GS_TARGET_AVX2 static bool decodeBlockAvx2(const char* in, uint8_t* out) {
+        const __m256i lutLo = _mm256_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i lutHi = _mm256_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i lutRoll = _mm256_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i mask2F = _mm256_set1_epi8(0x2F);
+
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+        const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(v, 4), mask2F);
+        const __m256i loNibbles = _mm256_and_si256(v, mask2F);
+        const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+        const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        if (!_mm256_testz_si256(lo, hi)) return false;
+
+        const __m256i isSlash = _mm256_cmpeq_epi8(v, mask2F);
+        const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(isSlash, hiNibbles));
+        v = _mm256_add_epi8(v, roll);
+
+        // Une 4 x 6 bits en 3 bytes por palabra y compacta 8 x 3 bytes.
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+        return true;
+    }
+#endif
+};
+
+
+/**
+ * @class Base64Encoder
+ * @brief Codificador Base64 por trozos para flujos de tamaño arbitrario.
+ *
+ * Guarda entre llamadas los 0..2 bytes que no completan un grupo de 3, de modo que
+ * concatenar las salidas de update() y finish() da lo mismo que Base64::encode()
+ * sobre todos los datos juntos, con memoria acotada.
+ */
+class Base64Encoder {
+public:
+    /**
+     * @brief Caracteres máximos que puede escribir update() con n bytes de entrada.
+     */
+    static size_t maxOutput(size_t n) {
+        return Base64::encodedLength(n + 2);
+    }
+
+    /**
+     * @brief Codifica un trozo.
+     * @param out Destino de al menos maxOutput(n) caracteres.
+     * @return size_t Caracteres escritos.
+     */
+    size_t update(const uint8_t* in, size_t n, char* out) {
+        size_t written = 0;
+        if (m_pending > 0) {
+            while (m_pending < 3 && n > 0) {
+                m_residual[m_pending++] = *in++;
+                n--;
+            }
+            if (m_pending < 3) return 0;
+            written += Base64::encode(m_residual, 3, out);
+            m_pending = 0;
+        }
+
+        const size_t whole = n / 3 * 3;
+        written += Base64::encode(in, whole, out + written);
+        for (size_t i = whole; i < n; ++i) m_residual[m_pending++] = in[i];
+        return written;
+    }
+
+    /**
+     * @brief Codifica los bytes pendientes con su relleno '='.
+     * @param out Destino de al menos 4 caracteres.
+     * @return size_t Caracteres escritos (0 o 4).
+     */
+    size_t finish(char* out) {
+        const size_t written = Base64::encode(m_residual, m_pending, out);
+        m_pending = 0;
+        return written;
+    }
+
+    /**
+     * @brief Codifica todo un flujo de entrada hacia uno de salida por bloques.
+     * @return uint64_t Bytes de entrada procesados.
+     * @throws std::runtime_error Si falla la escritura.
+     */
+    uint64_t process(std::istream& in, std::ostream& out, size_t chunkSize = 48 * 1024) {
+        std::vector<uint8_t> input(std::max<size_t>(chunkSize, 1));
+        std::vector<char> output(maxOutput(input.size()));
+        uint64_t total = 0;
+        while (in) {
+            in.read(reinterpret_cast<char*>(input.data()), static_cast<std::streamsize>(input.size()));
+            const size_t got = static_cast<size_t>(in.gcount());
+            if (got == 0) break;
+            write(out, output.data(), update(input.data(), got, output.data()));
+            total += got;
+        }
+        write(out, output.data(), finish(output.data()));
+        return total;
+    }
+
+private:
+    static void write(std::ostream& out, const char* data, size_t length) {
+        if (!out.write(data, static_cast<std::streamsize>(length))) {
+            throw std::runtime_error("Error al escribir el flujo de salida.");
+        }
+    }
+
+    uint8_t m_residual[3] = { 0, 0, 0 };  ///< Bytes que aún no completan un grupo de 3.
+    size_t m_pending = 0;                 ///< Bytes válidos en m_residual.
+};
+
+
+/**
+ * @class Base64Decoder
+ * @brief Decodificador Base64 por trozos para flujos de tamaño arbitrario.
+ *
+ * Arrastra entre llamadas los 0..3 caracteres de un cuanto incompleto (y si ya se
+ * vio el relleno final), así que un trozo puede cortarse en cualquier carácter.
+ */
+class Base64Decoder {
+public:
+    explicit Base64Decoder(Base64::Mode mode = Base64::Mode::IgnoreWhitespace) : m_mode(mode) {}
+
+    /**
+     * @brief Bytes máximos que puede escribir update() con n caracteres de entrada.
+     */
+    static size_t maxOutput(size_t n) {
+        return Base64::maxDecodedLength(n + 3);
+    }
+
+    /**
+     * @brief Decodifica un trozo.
+     * @param out Destino de al menos maxOutput(n) bytes.
+     * @return size_t Bytes escritos.
+     * @throws std::runtime_error Si el texto no es Base64 válido.
+     */
+    size_t update(const char* in, size_t n, uint8_t* out) {
+        return Base64::decodeChunk(in, n, out, m_mode, m_state);
+    }
+
+    /**
+     * @brief Comprueba que la entrada terminó en un cuanto completo.
+     * @throws std::runtime_error Si quedan caracteres sin completar un cuanto.
+     */
+    void finish() {
+        if (m_state.symbols != 0) {
+            throw std::runtime_error("Cadena Base64 inválida: termina a mitad de un bloque.");
+        }
+        m_state = Base64::DecodeState();
+    }
+
+    /**
+     * @brief Decodifica todo un flujo de entrada hacia uno de salida por bloques.
+     * @return uint64_t Bytes decodificados escritos.
+     * @throws std::runtime_error Si la entrada no es Base64 válida o falla la escritura.
+     */
+    uint64_t process(std::istream& in, std::ostream& out, size_t chunkSize = 64 * 1024) {
+        std::vector<char> input(std::max<size_t>(chunkSize, 1));
+        std::vector<uint8_t> output(maxOutput(input.size()));
+        uint64_t total = 0;
+        while (in) {
+            in.read(input.data(), static_cast<std::streamsize>(input.size()));
+            const size_t got = static_cast<size_t>(in.gcount());
+            if (got == 0) break;
+            const size_t written = update(input.data(), got, output.data());
+            if (!out.write(reinterpret_cast<const char*>(output.data()), static_cast<std::streamsize>(written))) {
+                throw std::runtime_error("Error al escribir el flujo de salida.");
+            }
+            total += written;
+        }
+        finish();
+        return total;
+    }
+
+private:
+    Base64::Mode m_mode;            ///< Estricto o tolerante a espacios.
+    Base64::DecodeState m_state;    ///< Cuanto incompleto entre trozos.
+};
@@ -0,0 +1,258 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+#include "RandomPool.h"
+
+/**
+ * @class BreachIndex
+ * @brief Comprobación local de contraseñas filtradas con un filtro de Bloom por bloques.
+ *
+ * build() convierte una lista de contraseñas (una por línea) en un índice compacto
+ * en disco; el constructor lo proyecta en memoria y contains() responde sin red y
+ * sin paso de carga: solo se valida la cabecera de 64 bytes.
+ *
+ * Formato: cabecera de 64 bytes seguida de bloques de 512 bits (una línea de caché).
+ * Cada contraseña elige un bloque con su hash y activa 7 bits dentro de él, así que
+ * una consulta cuesta un único fallo de caché. Con 16 bits por entrada (valor por
+ * defecto) la tasa de falsos positivos ronda el 0,1 %; nunca hay falsos negativos.
+ *
+ * El hash (MurmurHash64A) usa una semilla aleatoria guardada en la cabecera, de modo
+ * que no se pueden preparar colisiones contra un índice concreto sin conocerla.
+ */
+class BreachIndex {
+public:
+    /**
+     * @brief Resumen de un índice construido.
+     */
+    struct BuildInfo {
+        uint64_t entries = 0;   ///< Contraseñas insertadas (líneas no vacías).
+        uint64_t blocks = 0;    ///< Bloques de 64 bytes.
+        uint64_t bytes = 0;     ///< Tamaño del archivo de índice.
+    };
+
+    BreachIndex() = default;
+
+    /**
+     * @brief Abre un índice creado con build().
+     * @throws std::runtime_error Si el archivo no existe o no es un índice válido.
+     */
+    explicit BreachIndex(const std::string& path) {
+        open(path);
+    }
+
+    ~BreachIndex() = default;
+
+    BreachIndex(const BreachIndex&) = delete;
+    BreachIndex& operator=(const BreachIndex&) = delete;
+
+    BreachIndex(BreachIndex&& other) noexcept
+        : m_file(std::move(other.m_file)), m_header(other.m_header), m_blocks(other.m_blocks) {
+        other.m_blocks = nullptr;
+    }
+
+    BreachIndex& operator=(BreachIndex&& other) noexcept {
+        if (this != &other) {
+            m_file = std::move(other.m_file);
+            m_header = other.m_header;
+            m_blocks = other.m_blocks;
+            other.m_blocks = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Proyecta un índice, cerrando antes el actual si existe.
+     * @throws std::runtime_error Si el archivo no existe o no es un índice válido.
+     */
+    void open(const std::string& path) {
+        MappedFile file(path);
+        if (file.size() < sizeof(Header)) {
+            throw std::runtime_error("Índice de contraseñas inválido: " + path);
+        }
+        Header header;
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if (std::memcmp(header.magic, magic(), sizeof(header.magic)) != 0 ||
+            header.version != kVersion || header.hashesPerEntry != kHashesPerEntry ||
+            header.blockCount == 0 ||
+            header.blockCount > (std::numeric_limits<uint32_t>::max)() ||
+            file.size() != sizeof(Header) + header.blockCount * kBlockBytes) {
+            throw std::runtime_error("Índice de contraseñas inválido: " + path);
+        }
+        m_file = std::move(file);
+        m_header = header;
+        m_blocks = reinterpret_cast<const uint64_t*>(m_file.data() + sizeof(Header));
+    }
+
+    /**
+     * @brief Indica si la contraseña está (probablemente) en la lista filtrada.
+     *
+     * false es definitivo; true puede ser un falso positivo con la probabilidad
+     * del índice.
+     */
+    bool contains(const char* password, size_t length) const {
+        if (m_blocks == nullptr) return false;
+        const uint64_t hash = murmur64(password, length, m_header.seed);
+        const uint64_t* block = m_blocks + blockOf(hash, m_header.blockCount) * kBlockWords;
+        uint64_t found = 1;
+        uint64_t bits = bitSource(hash);
+        for (unsigned int i = 0; i < kHashesPerEntry; ++i, bits >>= 9) {
+            const unsigned int bit = static_cast<unsigned int>(bits & 511u);
+            found &= block[bit >> 6] >> (bit & 63);
+        }
+        return (found & 1u) != 0;
+    }
+
+    bool contains(const std::string& password) const {
+        return contains(password.data(), password.size());
+    }
+
+    bool isOpen() const { return m_blocks != nullptr; }
+    uint64_t entries() const { return m_header.entries; }
+    uint64_t blocks() const { return m_header.blockCount; }
+
+    /**
+     * @brief Construye un índice a partir de una lista de contraseñas.
+     *
+     * La lista se proyecta en memoria; las líneas vacías se ignoran y un '\r' final
+     * no forma parte de la contraseña.
+     *
+     * @param listPath Archivo con una contraseña por línea.
+     * @param indexPath Archivo de índice a crear (se sobrescribe).
+     * @param bitsPerEntry Bits del filtro por contraseña (más bits, menos falsos positivos).
+     * @return BuildInfo Resumen del índice escrito.
+     * @throws std::invalid_argument Si bitsPerEntry es 0.
+     * @throws std::runtime_error Si no se puede leer la lista o escribir el índice.
+     */
+    static BuildInfo build(const std::string& listPath, const std::string& indexPath,
+        unsigned int bitsPerEntry = 16) {
+        if (bitsPerEntry == 0) {
+            throw std::invalid_argument("bitsPerEntry debe ser mayor que 0.");
+        }
+        MappedFile list(listPath);
+        const char* text = reinterpret_cast<const char*>(list.data());
+
+        BuildInfo info;
+        forEachLine(text, list.size(), [&info](const char*, size_t) { info.entries++; });
+
+        const uint64_t bits = std::max<uint64_t>(info.entries, 1) * bitsPerEntry;
+        info.blocks = (bits + kBlockBytes * 8 - 1) / (kBlockBytes * 8);
+        if (info.blocks > (std::numeric_limits<uint32_t>::max)()) {
+            throw std::runtime_error("La lista es demasiado grande para un solo índice.");
+        }
+        info.bytes = sizeof(Header) + info.blocks * kBlockBytes;
+
+        Header header;
+        std::memcpy(header.magic, magic(), sizeof(header.magic));
+        header.blockCount = info.blocks;
+        header.entries = info.entries;
+        RandomPool::fill(reinterpret_cast<uint8_t*>(&header.seed), sizeof(header.seed));
+
+        std::vector<uint64_t> blocks(static_cast<size_t>(info.blocks) * kBlockWords, 0);
+        forEachLine(text, list.size(), [&](const char* line, size_t length) {
+            const uint64_t hash = murmur64(line, length, header.seed);
+            uint64_t* block = blocks.data() + blockOf(hash, header.blockCount) * kBlockWords;
+            uint64_t source = bitSource(hash);
+            for (unsigned int i = 0; i < kHashesPerEntry; ++i, source >>= 9) {
+                const unsigned int bit = static_cast<unsigned int>(source & 511u);
+                block[bit >> 6] |= 1ull << (bit & 63);
+            }
+        });
+
+        std::ofstream out(indexPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+            !out.write(reinterpret_cast<const char*>(blocks.data()),
+                static_cast<std::streamsize>(blocks.size() * sizeof(uint64_t)))) {
+            throw std::runtime_error("No se pudo escribir el índice: " + indexPath);
+        }
+        return info;
+    }
+
+private:
+    static const size_t kBlockBytes = 64;           ///< Un bloque = una línea de caché.
+    static const size_t kBlockWords = kBlockBytes / 8;
+    static const unsigned int kHashesPerEntry = 7;  ///< Bits (hashes) activados por contraseña en su bloque.
+    static const uint32_t kVersion = 1;
+
+    /**
+     * @brief Cabecera del archivo (64 bytes, en el orden de bytes de la máquina).
+     */
+    struct Header {
+        char magic[8] = { 0 };
+        uint32_t version = kVersion;
+        uint32_t hashesPerEntry = kHashesPerEntry;
+        uint64_t blockCount = 0;
+        uint64_t entries = 0;
+        uint64_t seed = 0;
+        uint8_t reserved[24] = { 0 };
+    };
+    static_assert(sizeof(Header) == 64, "La cabecera del índice debe ocupar 64 bytes.");
+
+    static const char* magic() { return "GSBREACH"; }
+
+    /**
+     * @brief Bloque del hash: los 32 bits altos escalados a [0, blockCount) sin división.
+     */
+    static size_t blockOf(uint64_t hash, uint64_t blockCount) {
+        return static_cast<size_t>(((hash >> 32) * blockCount) >> 32);
+    }
+
+    /**
+     * @brief 63 bits independientes del bloque para elegir 7 posiciones de 9 bits.
+     */
+    static uint64_t bitSource(uint64_t hash) {
+        uint64_t x = hash * 0x9E3779B97F4A7C15ull;
+        return x ^ (x >> 29);
+    }
+
+    /**
+     * @brief MurmurHash64A (Austin Appleby, dominio público).
+     */
+    static uint64_t murmur64(const char* data, size_t length, uint64_t seed) {
+        const uint64_t m = 0xC6A4A7935BD1E995ull;
+        const int r = 47;
+        uint64_t h = seed ^ (length * m);
+
+        const char* p = data;
+        const char* end = data + (length & ~static_cast<size_t>(7));
+        for (; p != end; p += 8) {
+            uint64_t k;
+            std::memcpy(&k, p, sizeof(k));
+            k *= m;
+            k ^= k >> r;
+            k *= m;
+            h ^= k;
+            h *= m;
+        }
+        const size_t rest = length & 7;
+        if (rest != 0) {
+            uint64_t k = 0;
+            for (size_t i = rest; i-- > 0;) k = (k << 8) | static_cast<uint8_t>(p[i]);
+            h ^= k;
+            h *= m;
+        }
+        h ^= h >> r;
+        h *= m;
+        h ^= h >> r;
+        return h;
+    }
+
+    /**
+     * @brief Llama a fn(inicio, longitud) por cada línea no vacía (sin '\r' final).
+     */
+    template <typename Fn>
+    static void forEachLine(const char* text, size_t size, Fn fn) {
+        size_t pos = 0;
+        while (pos < size) {
+            const char* newline = static_cast<const char*>(std::memchr(text + pos, '\n', size - pos));
+            const size_t end = newline != nullptr ? static_cast<size_t>(newline - text) : size;
+            size_t length = end - pos;
+            if (length > 0 && text[end - 1] == '\r') length--;
+            if (length > 0) fn(text + pos, length);
+            pos = end + 1;
+        }
+    }
+
+    MappedFile m_file;
+    Header m_header;
+    const uint64_t* m_blocks = nullptr;
+};
@@ -0,0 +1,89 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class CandidateFilter
+ * @brief Filtro de dos etapas para ataques de fuerza bruta.
+ *
+ * Primera etapa: cada candidato se descifra y puntúa solo sobre una muestra corta
+ * del texto (por defecto 256 bytes). Segunda etapa: solo los candidatos cuya
+ * puntuación de muestra queda a no más de `threshold` de la mejor muestra vista
+ * hasta ahora se descifran y puntúan completos. En textos de varios MB el trabajo
+ * total se reduce aproximadamente en la proporción muestra / texto.
+ *
+ * Un filtro construido por defecto está desactivado: admite todo y las rutas que
+ * lo usan se comportan exactamente como sin filtro.
+ *
+ * @note Guarda estado (mejor muestra y contadores): usar un filtro por ataque.
+ */
+class CandidateFilter {
+public:
+    /**
+     * @brief Filtro desactivado (todos los candidatos pasan a la segunda etapa).
+     */
+    CandidateFilter() = default;
+
+    /**
+     * @brief Filtro activo.
+     * @param sampleSize Bytes de la muestra de la primera etapa.
+     * @param threshold Margen respecto a la mejor muestra para pasar a la segunda etapa.
+     */
+    CandidateFilter(size_t sampleSize, double threshold)
+        : m_enabled(sampleSize > 0), m_sampleSize(sampleSize), m_threshold(threshold) {}
+
+    ~CandidateFilter() = default;
+
+    /**
+     * @brief Longitud de la muestra para un texto de `textLength` bytes.
+     */
+    size_t sampleLength(size_t textLength) const {
+        return m_enabled ? std::min(m_sampleSize, textLength) : textLength;
+    }
+
+    /**
+     * @brief true si la muestra ya es el texto completo (la segunda etapa no aporta nada).
+     */
+    bool coversWholeText(size_t textLength) const {
+        return sampleLength(textLength) == textLength;
+    }
+
+    /**
+     * @brief Decide si un candidato pasa a la segunda etapa y actualiza la mejor muestra.
+     * @param sampleScore Puntuación del candidato sobre la muestra.
+     * @return true si hay que descifrarlo y puntuarlo completo.
+     */
+    bool admit(double sampleScore) {
+        m_candidates++;
+        bool admitted = !m_enabled || sampleScore >= m_bestSample - m_threshold;
+        if (sampleScore > m_bestSample) m_bestSample = sampleScore;
+        if (admitted) m_admitted++;
+        return admitted;
+    }
+
+    /**
+     * @brief Olvida la mejor muestra y los contadores (para reutilizar el filtro).
+     */
+    void reset() {
+        m_bestSample = -std::numeric_limits<double>::infinity();
+        m_candidates = 0;
+        m_admitted = 0;
+    }
+
+    bool enabled() const { return m_enabled; }
+    size_t sampleSize() const { return m_sampleSize; }
+    double threshold() const { return m_threshold; }
+
+    /** @brief Candidatos evaluados en la primera etapa. */
+    uint64_t candidates() const { return m_candidates; }
+
+    /** @brief Candidatos que pasaron a la segunda etapa. */
+    uint64_t admitted() const { return m_admitted; }
+
+private:
+    bool m_enabled = false;         ///< false = filtro transparente.
+    size_t m_sampleSize = 256;      ///< Bytes de la muestra.
+    double m_threshold = 0.0;       ///< Margen respecto a la mejor muestra.
+    double m_bestSample = -std::numeric_limits<double>::infinity();
+    uint64_t m_candidates = 0;
+    uint64_t m_admitted = 0;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "Prerequisites.h"
+#include "CandidateFilter.h"
 
 /**
  * @class CesarEncryption
@@ -78,13 +79,29 @@ public:
      * Prueba todas las posibles claves (0 a 25) e imprime cada descifrado
      * posible en consola para permitir al usuario identificar el mensaje original.
      *
+     * Con un filtro activo, cada clave se prueba primero sobre la muestra inicial del
+     * texto (puntuada por proporcin de letras frecuentes del espaol) y solo las que
+     * quedan cerca de la mejor muestra se descifran completas e imprimen.
+     *
      * @param texto Texto cifrado a analizar.
+     * @param filtro Filtro de dos etapas opcional (nullptr = descifrar todas las claves).
+     *               Cada llamada trabaja con su propia copia, as que la mejor muestra
+     *               de un texto no se arrastra al siguiente.
      *
      * @note til como herramienta educativa para demostrar la debilidad de cifrados de sustitucin.
      */
-    void bruteForceAttack(const std::string& texto) {
+    void bruteForceAttack(const std::string& texto, const CandidateFilter* filtro = nullptr) {
         std::cout << "\nIntentos de descifrado por fuerza bruta:\n";
+        CandidateFilter etapas = filtro != nullptr ? *filtro : CandidateFilter();
+        etapas.reset();
+        const bool dosEtapas = !etapas.coversWholeText(texto.size());
+        const std::string muestra = dosEtapas
+            ? texto.substr(0, etapas.sampleLength(texto.size())) : std::string();
+
         for (int clave = 0; clave < 26; clave++) {
+            if (dosEtapas && !etapas.admit(puntuarMuestra(encode(muestra, 26 - clave)))) {
+                continue;
+            }
             std::string intento = encode(texto, 26 - clave);
             std::cout << "Clave " << clave << ": " << intento << std::endl;
         }
@@ -152,5 +169,23 @@ public:
     }
 
 private:
-    // No se requiere almacenamiento persistente en esta clase.
+    /**
+     * @brief Proporcin de letras frecuentes del espaol (e, a, o, s, r, n, i, d, l, c).
+     *
+     * Puntuacin barata para la primera etapa del filtro de candidatos.
+     */
+    static double puntuarMuestra(const std::string& texto) {
+        static const char frecuentes[] = "eaosrnidlc";
+        size_t letras = 0;
+        size_t comunes = 0;
+        for (char c : texto) {
+            unsigned int plegada = static_cast<unsigned char>(c) | 0x20u;
+            if (plegada - 'a' >= 26u) continue;
+            letras++;
+            if (std::memchr(frecuentes, static_cast<int>(plegada), sizeof(frecuentes) - 1) != nullptr) {
+                comunes++;
+            }
+        }
+        return letras == 0 ? 0.0 : static_cast<double>(comunes) / letras;
+    }
 };
@@ -0,0 +1,421 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Simd.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <bcrypt.h>
+#pragma comment(lib, "bcrypt.lib")
+#else
+#include <cerrno>
+#include <unistd.h>
+#include <sys/random.h>
+#endif
+
+/**
+ * @class ChaCha20Drbg
+ * @brief Generador de bytes aleatorios criptográficamente seguro basado en ChaCha20.
+ *
+ * La clave inicial (256 bits) sale del generador del sistema operativo
+ * (getrandom()/getentropy() en POSIX, BCryptGenRandom en Windows). Los bytes se
+ * producen en lotes de 8 bloques ChaCha20 (512 bytes) que se calculan a la vez con
+ * AVX2 si la CPU lo tiene (8 bloques) o SSE2 (2 x 4 bloques), y se sirven desde
+ * ese búfer.
+ *
+ * Tras cada lote, los primeros 32 bytes pasan a ser la clave del siguiente y se
+ * borran del búfer ("fast key erasure"): comprometer el estado no revela bytes ya
+ * entregados. Además, cada kReseedInterval bytes se mezcla entropía nueva del
+ * sistema operativo.
+ *
+ * Cumple UniformRandomBitGenerator (operator() devuelve 32 bits), así que también
+ * sirve con las distribuciones de <random>.
+ *
+ * @note No es seguro usar la misma instancia desde varios hilos a la vez.
+ */
+class ChaCha20Drbg {
+public:
+    using result_type = uint32_t;
+
+    static const size_t kBlockBytes = 64;                  ///< Bytes por bloque ChaCha20.
+    static const size_t kBatchBlocks = 8;                  ///< Bloques calculados por lote.
+    static const size_t kReseedInterval = size_t(1) << 24; ///< Bytes entre resiembras (16 MB).
+    static const size_t kDirectBlocks = 16384;             ///< Bloques máximos por clave en modo directo (1 MB).
+
+    /**
+     * @brief Generador sembrado con entropía del sistema operativo.
+     * @throws std::runtime_error Si el sistema no entrega entropía.
+     */
+    ChaCha20Drbg() {
+        uint8_t seed[32];
+        osEntropy(seed, sizeof(seed));
+        setKey(seed);
+        wipe(seed, sizeof(seed));
+    }
+
+    /**
+     * @brief Generador determinista a partir de una semilla fija (pruebas y reproducibilidad).
+     *
+     * No se resiembra con entropía del sistema: la misma semilla da la misma secuencia.
+     */
+    explicit ChaCha20Drbg(const uint8_t seed[32]) : m_reseed(false) {
+        setKey(seed);
+    }
+
+    ~ChaCha20Drbg() {
+        wipe(m_key, sizeof(m_key));
+        wipe(m_buffer, sizeof(m_buffer));
+    }
+
+    ChaCha20Drbg(const ChaCha20Drbg&) = delete;
+    ChaCha20Drbg& operator=(const ChaCha20Drbg&) = delete;
+
+    /**
+     * @brief Llena un búfer con bytes aleatorios.
+     *
+     * Las peticiones pequeñas (IVs, salts, claves) se sirven del lote en curso; las
+     * grandes escriben los bloques directamente en el destino, sin copia intermedia.
+     */
+    void generate(uint8_t* out, size_t length) {
+        while (length > 0) {
+            if (m_available == 0) {
+                if (length >= sizeof(m_buffer)) {
+                    const size_t done = generateDirect(out, length);
+                    out += done;
+                    length -= done;
+                    continue;
+                }
+                refill();
+            }
+            const size_t take = std::min(length, m_available);
+            uint8_t* source = m_buffer + sizeof(m_buffer) - m_available;
+            std::memcpy(out, source, take);
+            wipe(source, take);
+            m_available -= take;
+            out += take;
+            length -= take;
+        }
+    }
+
+    /**
+     * @brief Mezcla entropía nueva del sistema operativo en la clave.
+     * @throws std::runtime_error Si el sistema no entrega entropía.
+     */
+    void reseed() {
+        uint8_t fresh[32];
+        osEntropy(fresh, sizeof(fresh));
+        for (size_t i = 0; i < 32; ++i) m_key[i] ^= fresh[i];
+        wipe(fresh, sizeof(fresh));
+        wipe(m_buffer, sizeof(m_buffer));
+        m_available = 0;
+        m_sinceReseed = 0;
+    }
+
+    result_type operator()() {
+        uint8_t bytes[4];
+        generate(bytes, sizeof(bytes));
+        return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    /**
+     * @brief Calcula bloques ChaCha20 consecutivos (RFC 7539) con el mejor camino disponible.
+     *
+     * @param key Clave de 32 bytes.
+     * @param nonce Nonce de 12 bytes.
+     * @param counter Contador del primer bloque.
+     * @param blocks Número de bloques.
+     * @param out Destino de blocks * 64 bytes.
+     */
+    static void keystream(const uint8_t key[32], const uint8_t nonce[12], uint32_t counter,
+        size_t blocks, uint8_t* out) {
+        uint32_t state[16];
+        initState(state, key, nonce, counter);
+
+        size_t done = 0;
+#if defined(GS_HAS_AVX2)
+        if (gsCpuHasAvx2()) {
+            for (; done + 8 <= blocks; done += 8) {
+                blocks8(state, out + done * kBlockBytes);
+                state[12] += 8;
+            }
+        }
+#endif
+#if defined(GS_HAS_SSE2)
+        for (; done + 4 <= blocks; done += 4) {
+            blocks4(state, out + done * kBlockBytes);
+            state[12] += 4;
+        }
+#endif
+        for (; done < blocks; ++done) {
+            block(state, out + done * kBlockBytes);
+            state[12] += 1;
+        }
+        wipe(state, sizeof(state));
+    }
+
+    /**
+     * @brief Sobrescribe memoria con ceros sin que el compilador pueda omitirlo.
+     */
+    static void wipe(void* data, size_t length) {
+        volatile uint8_t* p = static_cast<volatile uint8_t*>(data);
+        while (length--) *p++ = 0;
+    }
+
+private:
+    /**
+     * @brief Obtiene bytes del generador aleatorio del sistema operativo.
+     * @throws std::runtime_error Si la llamada falla.
+     */
+    static void osEntropy(uint8_t* out, size_t length) {
+#if defined(_WIN32)
+        if (!BCRYPT_SUCCESS(BCryptGenRandom(nullptr, out, static_cast<ULONG>(length),
+            BCRYPT_USE_SYSTEM_PREFERRED_RNG))) {
+            throw std::runtime_error("BCryptGenRandom fallo al obtener entropia.");
+        }
+#elif defined(__linux__)
+        while (length > 0) {
+            ssize_t got = getrandom(out, length, 0);
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("getrandom fallo al obtener entropia.");
+            }
+            out += got;
+            length -= static_cast<size_t>(got);
+        }
+#else
+        while (length > 0) {
+            size_t take = std::min<size_t>(length, 256);
+            if (getentropy(out, take) != 0) {
+                throw std::runtime_error("getentropy fallo al obtener entropia.");
+            }
+            out += take;
+            length -= take;
+        }
+#endif
+    }
+
+    void setKey(const uint8_t key[32]) {
+        std::memcpy(m_key, key, 32);
+        m_available = 0;
+        m_sinceReseed = 0;
+    }
+
+    /**
+     * @brief Calcula un lote nuevo; sus primeros 32 bytes reemplazan la clave.
+     */
+    void refill() {
+        if (m_reseed && m_sinceReseed >= kReseedInterval) reseed();
+
+        static const uint8_t zeroNonce[12] = { 0 };
+        keystream(m_key, zeroNonce, 0, kBatchBlocks, m_buffer);
+        std::memcpy(m_key, m_buffer, 32);
+        wipe(m_buffer, 32);
+        m_available = sizeof(m_buffer) - 32;
+        m_sinceReseed += m_available;
+    }
+
+    /**
+     * @brief Escribe bloques completos en el destino (hasta kDirectBlocks).
+     *
+     * El bloque 0 de la clave actual da la clave siguiente; los bloques 1..n van al
+     * destino. @return size_t Bytes escritos (múltiplo de 64).
+     */
+    size_t generateDirect(uint8_t* out, size_t length) {
+        if (m_reseed && m_sinceReseed >= kReseedInterval) reseed();
+
+        static const uint8_t zeroNonce[12] = { 0 };
+        const size_t blocks = length / kBlockBytes < kDirectBlocks ? length / kBlockBytes : kDirectBlocks;
+        uint8_t next[kBlockBytes];
+        keystream(m_key, zeroNonce, 0, 1, next);
+        keystream(m_key, zeroNonce, 1, blocks, out);
+        std::memcpy(m_key, next, 32);
+        wipe(next, sizeof(next));
+        m_sinceReseed += blocks * kBlockBytes;
+        return blocks * kBlockBytes;
+    }
+
+    static uint32_t load32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+            (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    static void store32(uint8_t* p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+        p[2] = static_cast<uint8_t>(v >> 16);
+        p[3] = static_cast<uint8_t>(v >> 24);
+    }
+
+    static void initState(uint32_t state[16], const uint8_t key[32], const uint8_t nonce[12], uint32_t counter) {
+        state[0] = 0x61707865u;  // "expand 32-byte k"
+        state[1] = 0x3320646eu;
+        state[2] = 0x79622d32u;
+        state[3] = 0x6b206574u;
+        for (int i = 0; i < 8; ++i) state[4 + i] = load32(key + 4 * i);
+        state[12] = counter;
+        for (int i = 0; i < 3; ++i) state[13 + i] = load32(nonce + 4 * i);
+    }
+
+    static uint32_t rotl(uint32_t v, int n) {
+        return (v << n) | (v >> (32 - n));
+    }
+
+    static void quarterRound(uint32_t* x, int a, int b, int c, int d) {
+        x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 16);
+        x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 12);
+        x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 8);
+        x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 7);
+    }
+
+    /**
+     * @brief Un bloque (camino escalar).
+     */
+    static void block(const uint32_t state[16], uint8_t* out) {
+        uint32_t x[16];
+        std::memcpy(x, state, sizeof(x));
+        for (int round = 0; round < 10; ++round) {
+            quarterRound(x, 0, 4, 8, 12);
+            quarterRound(x, 1, 5, 9, 13);
+            quarterRound(x, 2, 6, 10, 14);
+            quarterRound(x, 3, 7, 11, 15);
+            quarterRound(x, 0, 5, 10, 15);
+            quarterRound(x, 1, 6, 11, 12);
+            quarterRound(x, 2, 7, 8, 13);
+            quarterRound(x, 3, 4, 9, 14);
+        }
+        for (int i = 0; i < 16; ++i) store32(out + 4 * i, x[i] + state[i]);
+        wipe(x, sizeof(x));
+    }
+
+#if defined(GS_HAS_SSE2)
+    template <int N>
+    static __m128i rotl128(__m128i v) {
+        return _mm_or_si128(_mm_slli_epi32(v, N), _mm_srli_epi32(v, 32 - N));
+    }
+
+    static void quarterRound4(__m128i* x, int a, int b, int c, int d) {
+        x[a] = _mm_add_epi32(x[a], x[b]); x[d] = rotl128<16>(_mm_xor_si128(x[d], x[a]));
+        x[c] = _mm_add_epi32(x[c], x[d]); x[b] = rotl128<12>(_mm_xor_si128(x[b], x[c]));
+        x[a] = _mm_add_epi32(x[a], x[b]); x[d] = rotl128<8>(_mm_xor_si128(x[d], x[a]));
+        x[c] = _mm_add_epi32(x[c], x[d]); x[b] = rotl128<7>(_mm_xor_si128(x[b], x[c]));
+    }
+
+    /**
+     * @brief Cuatro bloques a la vez: cada registro guarda la misma palabra de los 4 bloques.
+     */
+    static void blocks4(const uint32_t state[16], uint8_t* out) {
+        __m128i x[16];
+        __m128i initial[16];
+        for (int i = 0; i < 16; ++i) initial[i] = _mm_set1_epi32(static_cast<int>(state[i]));
+        initial[12] = _mm_add_epi32(initial[12], _mm_set_epi32(3, 2, 1, 0));
+        for (int i = 0; i < 16; ++i) x[i] = initial[i];
+
+        for (int round = 0; round < 10; ++round) {
+            quarterRound4(x, 0, 4, 8, 12);
+            quarterRound4(x, 1, 5, 9, 13);
+            quarterRound4(x, 2, 6, 10, 14);
+            quarterRound4(x, 3, 7, 11, 15);
+            quarterRound4(x, 0, 5, 10, 15);
+            quarterRound4(x, 1, 6, 11, 12);
+            quarterRound4(x, 2, 7, 8, 13);
+            quarterRound4(x, 3, 4, 9, 14);
+        }
+
+        // Transpone grupos de 4 palabras: (palabra, bloque) -> (bloque, palabra).
+        for (int w = 0; w < 16; w += 4) {
+            __m128i a = _mm_add_epi32(x[w], initial[w]);
+            __m128i b = _mm_add_epi32(x[w + 1], initial[w + 1]);
+            __m128i c = _mm_add_epi32(x[w + 2], initial[w + 2]);
+            __m128i d = _mm_add_epi32(x[w + 3], initial[w + 3]);
+            __m128i ab0 = _mm_unpacklo_epi32(a, b);
+            __m128i ab1 = _mm_unpackhi_epi32(a, b);
+            __m128i cd0 = _mm_unpacklo_epi32(c, d);
+            __m128i cd1 = _mm_unpackhi_epi32(c, d);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 0 * kBlockBytes + 4 * w), _mm_unpacklo_epi64(ab0, cd0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 1 * kBlockBytes + 4 * w), _mm_unpackhi_epi64(ab0, cd0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * kBlockBytes + 4 * w), _mm_unpacklo_epi64(ab1, cd1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 3 * kBlockBytes + 4 * w), _mm_unpackhi_epi64(ab1, cd1));
+        }
+    }
+#endif
+
+#if defined(GS_HAS_AVX2)
+    template <int N>
+    GS_TARGET_AVX2 static __m256i rotl256(__m256i v) {
+        return _mm256_or_si256(_mm256_slli_epi32(v, N), _mm256_srli_epi32(v, 32 - N));
+    }
+
+    GS_TARGET_AVX2 static void quarterRound8(__m256i* x, int a, int b, int c, int d) {
+        const __m256i rot16 = _mm256_setr_epi8(
+            2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+            2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+        const __m256i rot8 = _mm256_setr_epi8(
+            3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+            3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+        x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = _mm256_shuffle_epi8(_mm256_xor_si256(x[d], x[a]), rot16);
+        x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = rotl256<12>(_mm256_xor_si256(x[b], x[c]));
+        x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = _mm256_shuffle_epi8(_mm256_xor_si256(x[d], x[a]), rot8);
+        x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = rotl256<7>(_mm256_xor_si256(x[b], x[c]));
+    }
+
+    /**
+     * @brief Ocho bloques a la vez: cada registro guarda la misma palabra de los 8 bloques.
+     */
+    GS_TARGET_AVX2 static void blocks8(const uint32_t state[16], uint8_t* out) {
+        __m256i x[16];
+        __m256i initial[16];
+        for (int i = 0; i < 16; ++i) initial[i] = _mm256_set1_epi32(static_cast<int>(state[i]));
+        initial[12] = _mm256_add_epi32(initial[12], _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        for (int i = 0; i < 16; ++i) x[i] = initial[i];
+
+        for (int round = 0; round < 10; ++round) {
+            quarterRound8(x, 0, 4, 8, 12);
+            quarterRound8(x, 1, 5, 9, 13);
+            quarterRound8(x, 2, 6, 10, 14);
+            quarterRound8(x, 3, 7, 11, 15);
+            quarterRound8(x, 0, 5, 10, 15);
+            quarterRound8(x, 1, 6, 11, 12);
+            quarterRound8(x, 2, 7, 8, 13);
+            quarterRound8(x, 3, 4, 9, 14);
+        }
+
+        // Transpone grupos de 4 palabras; cada mitad de 128 bits va a un bloque distinto.
+        for (int w = 0; w < 16; w += 4) {
+            __m256i a = _mm256_add_epi32(x[w], initial[w]);
+            __m256i b = _mm256_add_epi32(x[w + 1], initial[w + 1]);
+            __m256i c = _mm256_add_epi32(x[w + 2], initial[w + 2]);
+            __m256i d = _mm256_add_epi32(x[w + 3], initial[w + 3]);
+            __m256i ab0 = _mm256_unpacklo_epi32(a, b);
+            __m256i ab1 = _mm256_unpackhi_epi32(a, b);
+            __m256i cd0 = _mm256_unpacklo_epi32(c, d);
+            __m256i cd1 = _mm256_unpackhi_epi32(c, d);
+            __m256i r0 = _mm256_unpacklo_epi64(ab0, cd0);  // bloques 0 y 4
+            __m256i r1 = _mm256_unpackhi_epi64(ab0, cd0);  // bloques 1 y 5
+            __m256i r2 = _mm256_unpacklo_epi64(ab1, cd1);  // bloques 2 y 6
+            __m256i r3 = _mm256_unpackhi_epi64(ab1, cd1);  // bloques 3 y 7
+            const __m256i rows[4] = { r0, r1, r2, r3 };
+            for (int b2 = 0; b2 < 4; ++b2) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + b2 * kBlockBytes + 4 * w),
+                    _mm256_castsi256_si128(rows[b2]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (b2 + 4) * kBlockBytes + 4 * w),
+                    _mm256_extracti128_si256(rows[b2], 1));
+            }
+        }
+    }
+#endif
+
+    uint8_t m_key[32];                                  ///< Clave actual (cambia tras cada lote).
+    uint8_t m_buffer[kBatchBlocks * kBlockBytes];       ///< Lote de salida pendiente de servir.
+    size_t m_available = 0;                             ///< Bytes sin servir al final de m_buffer.
+    size_t m_sinceReseed = 0;                           ///< Bytes servidos desde la última resiembra.
+    bool m_reseed = true;                               ///< false en el modo determinista.
+};
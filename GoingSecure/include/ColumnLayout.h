@@ -0,0 +1,100 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class ColumnLayout
+ * @brief Reordena un texto en L columnas contiguas (posición i -> columna i % L).
+ *
+ * Los cifrados periódicos (Vigenère, XOR con clave repetida) tratan cada columna
+ * como un cifrado de un solo byte. Recorrer el texto original con paso L hace que
+ * histogramas, índices de coincidencia o descifrados por columna salten por la
+ * memoria; tras reshape() cada columna es un bloque contiguo y esos bucles son de
+ * paso unitario (vectorizables).
+ *
+ * La columna k guarda los bytes k, k+L, k+2L... en ese orden. El mismo búfer se
+ * reutiliza entre llamadas, así que barrer L = 1..200 sobre un texto no reserva
+ * memoria más que la primera vez y cada reshape() es O(N).
+ */
+class ColumnLayout {
+public:
+    ColumnLayout() = default;
+    ~ColumnLayout() = default;
+
+    /**
+     * @brief Reparte los bytes en `period` columnas contiguas.
+     *
+     * @param data Bytes de entrada.
+     * @param length Número de bytes.
+     * @param period Longitud de la clave (L).
+     * @throws std::invalid_argument Si period es 0.
+     */
+    void reshape(const uint8_t* data, size_t length, size_t period) {
+        if (period == 0) {
+            throw std::invalid_argument("El periodo debe ser mayor que 0.");
+        }
+        m_period = period;
+        m_data.resize(length);
+        m_start.resize(period + 1);
+
+        const size_t rows = length / period;
+        const size_t rest = length % period;
+        m_start[0] = 0;
+        for (size_t k = 0; k < period; ++k) {
+            m_start[k + 1] = m_start[k] + rows + (k < rest ? 1 : 0);
+        }
+        if (length == 0) return;
+
+        if (period == 1) {
+            std::memcpy(m_data.data(), data, length);
+            return;
+        }
+
+        // Lectura secuencial por filas; cada columna se escribe en su propio flujo.
+        uint8_t* out = m_data.data();
+        const uint8_t* row = data;
+        for (size_t r = 0; r < rows; ++r, row += period) {
+            for (size_t k = 0; k < period; ++k) {
+                out[m_start[k] + r] = row[k];
+            }
+        }
+        for (size_t k = 0; k < rest; ++k) {
+            out[m_start[k] + rows] = row[k];
+        }
+    }
+
+    /**
+     * @brief Igual que reshape(data, length, period) sobre un std::string.
+     */
+    void reshape(const std::string& text, size_t period) {
+        reshape(reinterpret_cast<const uint8_t*>(text.data()), text.size(), period);
+    }
+
+    /**
+     * @brief Inicio de la columna k.
+     */
+    const uint8_t* column(size_t k) const { return m_data.data() + m_start[k]; }
+
+    /**
+     * @brief Número de bytes de la columna k.
+     */
+    size_t columnSize(size_t k) const { return m_start[k + 1] - m_start[k]; }
+
+    /**
+     * @brief Cuenta las apariciones de cada byte de la columna k.
+     * @param counts Arreglo de 256 contadores (se sobrescribe).
+     */
+    void histogram(size_t k, uint32_t* counts) const {
+        std::fill(counts, counts + 256, 0u);
+        const uint8_t* p = column(k);
+        const size_t n = columnSize(k);
+        for (size_t i = 0; i < n; ++i) counts[p[i]]++;
+    }
+
+    size_t period() const { return m_period; }
+    size_t size() const { return m_data.size(); }
+
+private:
+    std::vector<uint8_t> m_data;    ///< Columnas una tras otra (arena reutilizada).
+    std::vector<size_t> m_start;    ///< Inicio de cada columna (L + 1 entradas).
+    size_t m_period = 0;            ///< L de la última llamada a reshape().
+};
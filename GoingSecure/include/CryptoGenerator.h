@@ -1,5 +1,14 @@
 #pragma once
 #include "Prerequisites.h"
+#include "RandomPool.h"
+#include "Base64.h"
+#include "Hex.h"
+#include "PasswordBatch.h"
+#include "PasswordAuditor.h"
+#include "BreachIndex.h"
+#include "SecureArena.h"
+#include "Pbkdf2.h"
+#include "EntropyRing.h"
 
 /**
  * @class CryptoGenerator
@@ -12,13 +21,11 @@ public:
 	/**
 	 * @brief Constructor por defecto.
 	 *
-	 * Inicializa el motor Mersenne Twister con semilla extra?da de
-	 * std::random_device para garantizar entrop?a criptogr?fica.
+	 * Los bytes aleatorios salen de RandomPool: un generador ChaCha20 por hilo,
+	 * sembrado con 256 bits del sistema operativo (getrandom / BCryptGenRandom).
+	 * Una misma instancia puede usarse desde varios hilos sin bloqueos.
 	 */
-	CryptoGenerator() {
-		std::random_device rd;  // Dispositivo de generaci?n de n?meros aleatorios con alta entrop?a.
-		m_engine.seed(rd());    // Semilla el motor Mersenne Twister con la entrop?a del dispositivo.
-	}
+	CryptoGenerator() = default;
 
 	~CryptoGenerator() = default;
 
@@ -39,32 +46,37 @@ public:
 			bool useLower = true,
 			bool useDigits = true,
 			bool useSymbols = false) {
-		const std::string uppers = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-		const std::string lowers = "abcdefghijklmnopqrstuvwxyz";
-		const std::string digits = "0123456789";
-		const std::string symbols = "!@#$%^&*()-_=+[]{}|;:',.<>?/";
-
-		std::string pool;
-		if (useUpper) pool += uppers;
-		if (useLower) pool += lowers;
-		if (useDigits) pool += digits;
-		if (useSymbols) pool += symbols;
-
-		// Check if the pool is empty
-		if (pool.empty()) {
-			throw std::runtime_error("No character types enabled for password generation.");
-		}
-
-		std::uniform_int_distribution<unsigned int> dist(0, pool.size() - 1);
-		std::string password;
-		password.reserve(length);  // Reservar espacio para evitar reallocaciones.
-
-		for (unsigned int i = 0; i < length; ++i) {
-			password += pool[dist(m_engine)];  // Selecciona un car?cter aleatorio del pool.
+		std::string password(length, '\0');
+		if (length > 0) {
+			PasswordBatch(characterPool(useUpper, useLower, useDigits, useSymbols)).fill(&password[0], length);
 		}
 		return password;  // Devuelve la contrase?a generada.
 	}
 
+	/**
+	 * @brief Genera muchas contrasenas de una vez en un bloque contiguo.
+	 *
+	 * Prepara el alfabeto una sola vez y pide los bytes aleatorios por bloques,
+	 * sin una reserva ni una distribucion por contrasena.
+	 *
+	 * @param count   Cantidad de contrasenas.
+	 * @param length  Longitud de cada contrasena.
+	 * @param threads Hilos a usar (0 = todos los nucleos, 1 = solo el actual).
+	 * @return PasswordArena Contrasenas contiguas; arena.str(i) devuelve la i-esima.
+	 * @throws std::runtime_error Si no esta habilitado ningun tipo de caracter.
+	 */
+	PasswordArena
+		generatePasswords(size_t count,
+			unsigned int length,
+			bool useUpper = true,
+			bool useLower = true,
+			bool useDigits = true,
+			bool useSymbols = false,
+			unsigned int threads = 1) {
+		return PasswordBatch(characterPool(useUpper, useLower, useDigits, useSymbols))
+			.generate(count, length, threads);
+	}
+
 	/**
 		 * @brief Genera un buffer de bytes aleatorios.
 		 *
@@ -74,37 +86,54 @@ public:
 	std::vector<uint8_t>
 		generateBytes(unsigned int numBytes) {
 		std::vector<uint8_t> bytes(numBytes);
-		std::uniform_int_distribution<int> dist(0, 255);  // Distribuci?n uniforme en el rango [0x00?0xFF].
-		for (unsigned int i = 0; i < numBytes; ++i) {
-			bytes[i] = static_cast<uint8_t>(dist(m_engine));  // Asigna un byte aleatorio al vector.
-		}
+		fillRandom(bytes.data(), bytes.size());  // Bloques ChaCha20 en lote, sin coste por byte.
 		return bytes;  // Devuelve el vector de bytes generados.
 	}
 
+	/**
+	 * @brief Llena un buffer existente con bytes aleatorios (sin reservar memoria).
+	 *
+	 * Usa el generador del hilo actual; nunca toma un mutex.
+	 *
+	 * @param data Inicio del buffer.
+	 * @param length Cantidad de bytes a generar.
+	 */
+	void
+		fillRandom(uint8_t* data, size_t length) {
+		RandomPool::fill(data, length);
+	}
+
+	/**
+	 * @brief Llena todo el vector con bytes aleatorios.
+	 */
+	void
+		fillRandom(std::vector<uint8_t>& data) {
+		fillRandom(data.data(), data.size());
+	}
+
 	// Convierte bytes a cadena hexadecimal
 	std::string
-		toHex(const std::vector<uint8_t>& data) {
-		std::ostringstream oss;
+		toHex(const std::vector<uint8_t>& data, bool upperCase = false) {
+		return Hex::encode(data, upperCase ? Hex::Case::Upper : Hex::Case::Lower);  // Salida reservada con su tamano exacto (2 * n).
+	}
 
-		for (const auto& byte : data) {
-			oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
-		}
-		return oss.str();  // Convierte el vector de bytes a una cadena hexadecimal.
+	/**
+	 * @brief Escribe la representacion hexadecimal en un buffer del llamador (sin reservar memoria).
+	 *
+	 * @param data Bytes de entrada.
+	 * @param length Cantidad de bytes.
+	 * @param out Destino de al menos 2 * length caracteres (no se agrega terminador).
+	 * @return size_t Caracteres escritos.
+	 */
+	size_t
+		toHex(const uint8_t* data, size_t length, char* out, bool upperCase = false) {
+		return Hex::encode(data, length, out, upperCase ? Hex::Case::Upper : Hex::Case::Lower);
 	}
 
 	// Decodifica una cadena hexadecimal a bytes
 	std::vector<uint8_t>
 		fromHex(const std::string& hex) {
-		if (hex.size() % 2 != 0)
-			throw std::runtime_error("Hex inv?lido (longitud impar).");
-
-		std::vector<uint8_t> data(hex.size() / 2);
-		for (size_t i = 0; i < data.size(); ++i) {
-			unsigned int byte;
-			std::istringstream(hex.substr(2 * i, 2)) >> std::hex >> byte;
-			data[i] = static_cast<uint8_t>(byte);
-		}
-		return data;
+		return Hex::decode(hex);  // Rechaza longitud impar y caracteres no hexadecimales.
 	}
 
 	/**
@@ -150,6 +179,81 @@ public:
 		return generateBytes(length);
 	}
 
+	/**
+	 * @brief Genera un IV tomandolo de un anillo rellenado en segundo plano.
+	 *
+	 * Opcional: generateIV(blockSize) sigue generando en el momento. Si el tamano
+	 * de los valores del anillo no coincide con blockSize, se genera en el momento.
+	 *
+	 * @param blockSize Tamano del IV en bytes.
+	 * @param ring      Anillo del que tomar el valor.
+	 * @return std::vector<uint8_t> IV generado.
+	 */
+	std::vector<uint8_t>
+		generateIV(unsigned int blockSize, EntropyRing& ring) {
+		return takeFrom(ring, blockSize);
+	}
+
+	/**
+	 * @brief Genera una salt tomandola de un anillo rellenado en segundo plano.
+	 *
+	 * Igual que generateIV(blockSize, ring): si el tamano no coincide, se genera
+	 * en el momento.
+	 *
+	 * @param length Longitud de la salt en bytes.
+	 * @param ring   Anillo del que tomar el valor.
+	 * @return std::vector<uint8_t> Salt generada.
+	 */
+	std::vector<uint8_t>
+		generateSalt(unsigned int length, EntropyRing& ring) {
+		return takeFrom(ring, length);
+	}
+
+	/**
+	 * @brief Anillo compartido de IVs de 16 bytes (AES).
+	 *
+	 * Se crea, junto con su hilo productor, la primera vez que se pide.
+	 */
+	static EntropyRing&
+		ivRing() {
+		static EntropyRing ring(16);
+		return ring;
+	}
+
+	/**
+	 * @brief Devuelve un IV de 16 bytes del anillo compartido ivRing().
+	 */
+	std::vector<uint8_t>
+		takeIV() {
+		return ivRing().take();
+	}
+
+	/**
+	 * @brief Deriva una clave de una contrasena con PBKDF2-HMAC-SHA256.
+	 *
+	 * Sustituye usar la contrasena tecleada directamente como clave (Vigenere, XOR,
+	 * DES). La salt debe salir de generateSalt() y guardarse junto al cifrado.
+	 *
+	 * @param password   Contrasena del usuario.
+	 * @param salt       Salt aleatoria (16 bytes o mas).
+	 * @param iterations Iteraciones de PBKDF2 (600000 por defecto, recomendacion OWASP).
+	 * @param length     Bytes de clave a derivar.
+	 * @return SecureBytes Clave derivada en memoria bloqueada.
+	 * @throws std::invalid_argument Si iterations es 0.
+	 */
+	SecureBytes
+		deriveKey(const std::string& password,
+			const std::vector<uint8_t>& salt,
+			uint32_t iterations = 600000,
+			size_t length = 32) {
+		SecureBytes key(length);
+		if (length > 0) {
+			Pbkdf2::derive(reinterpret_cast<const uint8_t*>(password.data()), password.size(),
+				salt.data(), salt.size(), iterations, key.data(), key.size());
+		}
+		return key;
+	}
+
 	/**
 		 * @brief Convierte un vector de bytes a una cadena Base64.
 		 *
@@ -158,44 +262,7 @@ public:
 		 */
 	std::string
 		toBase64(const std::vector<uint8_t>& data) {
-		static const char* table =
-			"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-			"abcdefghijklmnopqrstuvwxyz"
-			"0123456789+/";
-		std::string b64;
-		unsigned int i = 0;
-
-		/**
-		 * Procesar bloques de 3 bytes.Tomamos 3 bytes y los concatenamos en un entero de 24 bits.
-		 * Ese entero lo dividimos en cuatro ?seis bits? (24 ? 6 = 4).
-		 * Cada grupo de 6 bits (valor 0?63) se usa como ?ndice en la table para obtener un car?cter.
-		 */
-		while (i + 2 < data.size()) {
-			unsigned int block = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
-			b64 += table[(block >> 18) & 0x3F];
-			b64 += table[(block >> 12) & 0x3F];
-			b64 += table[(block >> 6) & 0x3F];
-			b64 += table[(block) & 0x3F];
-			i += 3;
-		}
-
-		// Procesar los ?ltimos 1 o 2 bytes restantes, a?adiendo relleno '=' si es necesario.
-		if (i < data.size()) {
-			uint32_t block = data[i] << 16;
-			b64 += table[(block >> 18) & 0x3F];
-			if (i + 1 < data.size()) {
-				block |= data[i + 1] << 8;
-				b64 += table[(block >> 12) & 0x3F];
-				b64 += table[(block >> 6) & 0x3F];
-				b64 += '=';
-			}
-			else {
-				b64 += table[(block >> 12) & 0x3F];
-				b64 += "==";
-			}
-		}
-
-		return b64;  // Devuelve la cadena Base64 generada.
+		return Base64::encode(data);  // Salida reservada con su tamano exacto (4 * ceil(n / 3)).
 	}
 
 	/**
@@ -207,42 +274,45 @@ public:
 		 */
 	std::vector<uint8_t>
 		fromBase64(const std::string& b64) {
-		std::lock_guard<std::mutex> lock(_mtx);
-		std::vector<uint8_t> out;
-		size_t len = b64.size();
-		size_t pad = 0;
-
-		if (len >= 1 && b64[len - 1] == '=') pad++;
-		if (len >= 2 && b64[len - 2] == '=') pad++;
-		out.reserve(((len / 4) * 3) - pad);
-
-		unsigned int i = 0;
-		while (i < len) {
-			uint32_t block = 0;
-			unsigned int chars = 0;
-			for (unsigned int j = 0; j < 4 && i < len; ++j, ++i) {
-				uint8_t v = _decTable[(unsigned char)b64[i]];
-				if (v == 0xFF) { j--; continue; }
-				block = (block << 6) | v;  // Desplaza el bloque y agrega el valor del car?cter.
-				chars++;
-			}
-			for (unsigned int k = 0; k < chars - 1; ++k) {
-				out.push_back((block >> (8 * (chars - 2 - k))) & 0xFF);
-			}
-		}
-		return out;  // Devuelve el vector de bytes decodificados.
+		// Sin estado compartido: no necesita mutex. Se aceptan saltos de linea y espacios.
+		return Base64::decode(b64, Base64::Mode::IgnoreWhitespace);
 	}
 
 	/**
 	 * @brief Limpia de forma segura los datos sensibles en un vector.
 	 *
-	 * Sobrescribe cada byte con cero para evitar filtraciones en memoria.
+	 * Sobrescribe cada byte con cero para evitar filtraciones en memoria; a diferencia
+	 * de std::fill, el compilador no puede omitir la escritura aunque el vector no se
+	 * vuelva a leer.
 	 *
 	 * @param data Vector cuyos elementos ser?n limpiados.
 	 */
 	void
 		secureWipe(std::vector<uint8_t>& data) {
-		std::fill(data.begin(), data.end(), 0);
+		SecureArena::wipe(data.data(), data.size());
+	}
+
+	/**
+	 * @brief Genera una clave en memoria bloqueada (SecureArena) que se borra al liberarse.
+	 *
+	 * @param bits Tamano de la clave en bits (debe ser multiplo de 8).
+	 * @return SecureBytes Clave generada (bits/8 bytes), sin pasar por malloc.
+	 * @throws std::runtime_error Si bits no es multiplo de 8.
+	 */
+	SecureBytes
+		generateSecureKey(unsigned int bits) {
+		if (bits % 8 != 0) {
+			throw std::runtime_error("Bits debe ser multiplo de 8.");
+		}
+		return generateSecureBytes(bits / 8);
+	}
+
+	/**
+	 * @brief Genera un IV en memoria bloqueada (SecureArena) que se borra al liberarse.
+	 */
+	SecureBytes
+		generateSecureIV(unsigned int blockSize) {
+		return generateSecureBytes(blockSize);
 	}
 
 	/**
@@ -255,29 +325,57 @@ public:
 	 */
 	bool
 		validatePassword(const std::string& password) {
-		if (password.size() < 8) return false;
-		bool hasUpper = false, hasLower = false, hasDigit = false, hasSymbols = false;
-		for (char c : password) {
-			if (std::isupper((unsigned char)c)) {
-				hasUpper = true;
-			}
-			else if (std::islower((unsigned char)c)) {
-				hasLower = true;
-			}
-			else if (std::isdigit((unsigned char)c)) {
-				hasDigit = true;
-			}
-			else if (std::ispunct((unsigned char)c)) {
-				hasSymbols = true;
-			}
-		}
+		// Clases ASCII sin depender del locale; la politica por defecto del auditor es esta misma.
+		return PasswordAuditor().check(password) == 0;
+	}
 
-		return hasUpper && hasLower && hasDigit && hasSymbols;
+	/**
+	 * @brief Igual que validatePassword(password) y ademas exige que la contrasena no
+	 *        aparezca en un indice local de contrasenas filtradas.
+	 *
+	 * @param password Contrasena a validar.
+	 * @param breached Indice creado con BreachIndex::build (consulta de un fallo de cache).
+	 * @return true si cumple la politica y no esta en la lista; false en caso contrario.
+	 */
+	bool
+		validatePassword(const std::string& password, const BreachIndex& breached) {
+		return validatePassword(password) && !breached.contains(password);
 	}
 
 private:
-	std::mt19937 m_engine;  ///< Motor de generaci?n de n?meros aleatorios Mersenne Twister.
-	std::mutex _mtx;          ///< Mutex para uso thread-safe.
-	std::array<uint8_t, 256> _decTable;  ///< Tabla de decodificaci?n Base64.
+	std::vector<uint8_t>
+		takeFrom(EntropyRing& ring, unsigned int length) {
+		if (ring.itemSize() != length) {
+			return generateBytes(length);
+		}
+		return ring.take();
+	}
+
+	/**
+	 * @brief Alfabeto de contrasenas segun los tipos de caracter habilitados.
+	 * @throws std::runtime_error Si no esta habilitado ningun tipo de caracter.
+	 */
+	static std::string
+		characterPool(bool useUpper, bool useLower, bool useDigits, bool useSymbols) {
+		std::string pool;
+		if (useUpper) pool += "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+		if (useLower) pool += "abcdefghijklmnopqrstuvwxyz";
+		if (useDigits) pool += "0123456789";
+		if (useSymbols) pool += "!@#$%^&*()-_=+[]{}|;:',.<>?/";
+
+		// Check if the pool is empty
+		if (pool.empty()) {
+			throw std::runtime_error("No character types enabled for password generation.");
+		}
+		return pool;
+	}
+
+	SecureBytes
+		generateSecureBytes(unsigned int numBytes) {
+		SecureBytes bytes(numBytes);
+		if (numBytes > 0) fillRandom(bytes.data(), bytes.size());
+		return bytes;
+	}
 
+	// Sin estado propio: los bytes aleatorios salen de RandomPool (un generador por hilo).
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "Prerequisites.h"
+#include "SecureArena.h"
 
 /**
  * @class DES
@@ -16,9 +17,13 @@ public:
         generateSubkeys();
     }
 
-    ~DES() = default;
+    ~DES() {
+        SecureArena::wipe(&key, sizeof(key));
+    }
 
     void generateSubkeys() {
+        subkeys.clear();
+        subkeys.reserve(16);  // Una sola reserva en la arena segura.
         for (int i = 0; i < 16; ++i) {
             std::bitset<48> subkey((key.to_ullong() >> i) & 0xFFFFFFFFFFFF);
             subkeys.push_back(subkey);
@@ -62,7 +67,7 @@ public:
 
 private:
     std::bitset<64> key;
-    std::vector<std::bitset<48>> subkeys;
+    std::vector<std::bitset<48>, SecureAllocator<std::bitset<48>>> subkeys;  ///< En memoria bloqueada; se borran al liberarse.
 
     const int EXPANSION_TABLE[48] = {
       32, 1, 2, 3, 4, 5,
@@ -0,0 +1,124 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "RandomPool.h"
+#include "SecureArena.h"
+
+/**
+ * @class DesKeyFactory
+ * @brief Genera claves DES en lote, con paridad impar y sin claves débiles.
+ *
+ * Las claves salen empaquetadas en uint64_t con el byte i de la clave en los bits
+ * 8i..8i+7 (el mismo orden que stringToBitset), así que std::bitset<64>(clave) va
+ * directo al constructor de DES.
+ *
+ * - Todos los bytes aleatorios se piden a RandomPool de una vez.
+ * - La paridad se ajusta con operaciones SWAR: los 8 bytes de una clave en unas
+ *   pocas instrucciones de 64 bits, sin bucles por byte (el bucle sobre las claves
+ *   lo vectoriza el compilador).
+ * - Las 4 claves débiles y 12 semidébiles se rechazan comparando con las 16 de la
+ *   tabla sin saltos dependientes de la clave (tiempo constante).
+ */
+class DesKeyFactory {
+public:
+    /**
+     * @brief Pone el bit menos significativo de cada byte para que tenga paridad impar.
+     */
+    static uint64_t fixParity(uint64_t key) {
+        const uint64_t lowBits = 0x0101010101010101ull;
+        const uint64_t data = key & ~lowBits;
+        // Bit 0 de cada byte = XOR de sus bits 1..7 (los desplazamientos no mezclan bytes en el bit 0).
+        uint64_t parity = data ^ (data >> 4);
+        parity ^= parity >> 2;
+        parity ^= parity >> 1;
+        return data | (~parity & lowBits);
+    }
+
+    /**
+     * @brief Indica si la clave (con paridad ya ajustada) es débil o semidébil.
+     *
+     * Recorre siempre las 16 entradas y combina los resultados sin saltos.
+     */
+    static bool isWeak(uint64_t key) {
+        const WeakTable& table = weakTable();
+        uint64_t match = 0;
+        for (size_t i = 0; i < kWeakKeys; ++i) {
+            const uint64_t diff = key ^ table.keys[i];
+            // 1 si diff == 0: (diff | -diff) tiene el bit alto a 1 para cualquier diff != 0.
+            match |= ((diff | (0 - diff)) >> 63) ^ 1u;
+        }
+        return match != 0;
+    }
+
+    /**
+     * @brief Llena out con count claves válidas.
+     */
+    static void generate(uint64_t* out, size_t count) {
+        if (count == 0) return;
+        RandomPool::fill(reinterpret_cast<uint8_t*>(out), count * sizeof(uint64_t));
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = fixParity(out[i]);
+        }
+        // Probabilidad 16 / 2^56 por clave: en la práctica este bucle nunca repite.
+        for (size_t i = 0; i < count; ++i) {
+            while (isWeak(out[i])) {
+                RandomPool::fill(reinterpret_cast<uint8_t*>(&out[i]), sizeof(uint64_t));
+                out[i] = fixParity(out[i]);
+            }
+        }
+    }
+
+    static std::vector<uint64_t> generate(size_t count) {
+        std::vector<uint64_t> keys(count);
+        generate(keys.data(), count);
+        return keys;
+    }
+
+    static uint64_t generate() {
+        uint64_t key;
+        generate(&key, 1);
+        return key;
+    }
+
+    /**
+     * @brief Clave empaquetada a 8 caracteres (el formato que usa el menú de archivos).
+     */
+    static std::string toString(uint64_t key) {
+        std::string bytes(8, '\0');
+        for (size_t i = 0; i < 8; ++i) bytes[i] = static_cast<char>(key >> (8 * i));
+        return bytes;
+    }
+
+private:
+    static const size_t kWeakKeys = 16;
+
+    struct WeakTable {
+        uint64_t keys[kWeakKeys];
+    };
+
+    /**
+     * @brief Convierte una clave escrita como bytes en orden (p. ej. 0x011F011F010E010E,
+     * byte 0 = 0x01) al empaquetado de esta clase.
+     */
+    static constexpr uint64_t fromBytes(uint64_t written) {
+        return ((written >> 56) & 0xFF) | (((written >> 48) & 0xFF) << 8) |
+            (((written >> 40) & 0xFF) << 16) | (((written >> 32) & 0xFF) << 24) |
+            (((written >> 24) & 0xFF) << 32) | (((written >> 16) & 0xFF) << 40) |
+            (((written >> 8) & 0xFF) << 48) | ((written & 0xFF) << 56);
+    }
+
+    static const WeakTable& weakTable() {
+        static constexpr WeakTable table = { {
+            // Débiles.
+            fromBytes(0x0101010101010101ull), fromBytes(0xFEFEFEFEFEFEFEFEull),
+            fromBytes(0xE0E0E0E0F1F1F1F1ull), fromBytes(0x1F1F1F1F0E0E0E0Eull),
+            // Semidébiles (por parejas).
+            fromBytes(0x011F011F010E010Eull), fromBytes(0x1F011F010E010E01ull),
+            fromBytes(0x01E001E001F101F1ull), fromBytes(0xE001E001F101F101ull),
+            fromBytes(0x01FE01FE01FE01FEull), fromBytes(0xFE01FE01FE01FE01ull),
+            fromBytes(0x1FE01FE00EF10EF1ull), fromBytes(0xE01FE01FF10EF10Eull),
+            fromBytes(0x1FFE1FFE0EFE0EFEull), fromBytes(0xFE1FFE1FFE0EFE0Eull),
+            fromBytes(0xE0FEE0FEF1FEF1FEull), fromBytes(0xFEE0FEE0FEF1FEF1ull)
+        } };
+        return table;
+    }
+};
@@ -0,0 +1,209 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "RandomPool.h"
+#include "SecureArena.h"
+
+/**
+ * @class EntropyRing
+ * @brief Anillo de IVs, nonces o salts ya generados, rellenado por un hilo en segundo plano.
+ *
+ * Un hilo productor llena por adelantado un anillo de `capacity` valores de
+ * `itemSize` bytes con el mismo generador que CryptoGenerator (RandomPool). Pedir
+ * un valor con take() cuesta reclamar una posición con una operación atómica y
+ * copiar los bytes; no se genera nada en el hilo que cifra.
+ *
+ * - Un productor, varios consumidores y sin bloqueos: cada casilla lleva un número
+ *   de secuencia que indica si está llena o libre (esquema de Vyukov).
+ * - Marcas de nivel: cuando quedan menos de `lowWatermark` valores, el consumidor
+ *   despierta al productor, que rellena hasta llenar el anillo y vuelve a dormir.
+ * - Si el anillo está vacío, take() genera el valor en el momento y lo cuenta como
+ *   subdesbordamiento en stats().
+ *
+ * Cada casilla se borra en cuanto se consume.
+ */
+class EntropyRing {
+public:
+    /**
+     * @brief Contadores de uso.
+     */
+    struct Stats {
+        uint64_t served = 0;        ///< Valores entregados desde el anillo.
+        uint64_t underflows = 0;    ///< Peticiones con el anillo vacío (generadas en el momento).
+        uint64_t produced = 0;      ///< Valores generados por el productor.
+        uint64_t wakeups = 0;       ///< Veces que se despertó al productor por la marca baja.
+    };
+
+    /**
+     * @param itemSize Bytes de cada valor (16 para un IV de AES, 12 para un nonce...).
+     * @param capacity Valores en el anillo (se redondea a potencia de 2).
+     * @param lowWatermark Nivel por debajo del cual se despierta al productor (0 = capacity / 4).
+     * @throws std::invalid_argument Si itemSize o capacity son 0.
+     */
+    explicit EntropyRing(size_t itemSize = 16, size_t capacity = 4096, size_t lowWatermark = 0)
+        : m_itemSize(itemSize) {
+        if (itemSize == 0 || capacity == 0) {
+            throw std::invalid_argument("El anillo necesita itemSize y capacity mayores que 0.");
+        }
+        m_capacity = 1;
+        while (m_capacity < capacity) m_capacity <<= 1;
+        m_mask = m_capacity - 1;
+        m_lowWatermark = lowWatermark != 0 && lowWatermark < m_capacity ? lowWatermark : m_capacity / 4;
+
+        m_data.assign(m_capacity * m_itemSize, 0);
+        m_sequence.reset(new std::atomic<uint64_t>[m_capacity]);
+        for (size_t i = 0; i < m_capacity; ++i) m_sequence[i].store(i, std::memory_order_relaxed);
+
+        m_producer = std::thread([this] { produce(); });
+    }
+
+    ~EntropyRing() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_producer.join();
+        SecureArena::wipe(m_data.data(), m_data.size());
+    }
+
+    EntropyRing(const EntropyRing&) = delete;
+    EntropyRing& operator=(const EntropyRing&) = delete;
+
+    /**
+     * @brief Copia un valor nuevo de itemSize() bytes en out.
+     *
+     * Seguro desde cualquier número de hilos.
+     *
+     * @return true si salió del anillo; false si estaba vacío y se generó en el momento.
+     */
+    bool take(uint8_t* out) {
+        uint64_t pos = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            const uint64_t sequence = m_sequence[pos & m_mask].load(std::memory_order_acquire);
+            const int64_t diff = static_cast<int64_t>(sequence - (pos + 1));
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) {
+                // Casilla aún sin rellenar: anillo vacío.
+                m_underflows.fetch_add(1, std::memory_order_relaxed);
+                wakeProducer();
+                RandomPool::fill(out, m_itemSize);
+                return false;
+            }
+            else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+
+        uint8_t* slot = m_data.data() + (pos & m_mask) * m_itemSize;
+        std::memcpy(out, slot, m_itemSize);
+        SecureArena::wipe(slot, m_itemSize);
+        m_sequence[pos & m_mask].store(pos + m_capacity, std::memory_order_release);
+        m_served.fetch_add(1, std::memory_order_relaxed);
+
+        if (level() < m_lowWatermark) wakeProducer();
+        return true;
+    }
+
+    /**
+     * @brief Igual que take(out), devolviendo el valor en un vector.
+     */
+    std::vector<uint8_t> take() {
+        std::vector<uint8_t> value(m_itemSize);
+        take(value.data());
+        return value;
+    }
+
+    /**
+     * @brief Valores listos en este momento (aproximado con consumidores activos).
+     */
+    size_t level() const {
+        const uint64_t tail = m_tail.load(std::memory_order_acquire);
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        return tail > head ? static_cast<size_t>(tail - head) : 0;
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.served = m_served.load(std::memory_order_relaxed);
+        s.underflows = m_underflows.load(std::memory_order_relaxed);
+        s.produced = m_produced.load(std::memory_order_relaxed);
+        s.wakeups = m_wakeups.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    size_t itemSize() const { return m_itemSize; }
+    size_t capacity() const { return m_capacity; }
+    size_t lowWatermark() const { return m_lowWatermark; }
+
+private:
+    void wakeProducer() {
+        if (m_sleeping.load()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_sleeping.exchange(false)) {
+                m_wakeups.fetch_add(1, std::memory_order_relaxed);
+                m_wake.notify_one();
+            }
+        }
+    }
+
+    /**
+     * @brief Hilo productor: rellena tramos contiguos de casillas libres con una sola
+     * llamada al generador y duerme cuando el anillo está lleno.
+     */
+    void produce() {
+        uint64_t tail = 0;
+        for (;;) {
+            // Casillas libres consecutivas a partir de tail (sin dar la vuelta al anillo).
+            size_t run = 0;
+            const size_t first = static_cast<size_t>(tail & m_mask);
+            while (first + run < m_capacity &&
+                m_sequence[first + run].load(std::memory_order_acquire) == tail + run) {
+                ++run;
+            }
+
+            if (run > 0) {
+                RandomPool::fill(m_data.data() + first * m_itemSize, run * m_itemSize);
+                for (size_t i = 0; i < run; ++i) {
+                    m_sequence[first + i].store(tail + i + 1, std::memory_order_release);
+                }
+                tail += run;
+                m_tail.store(tail, std::memory_order_release);
+                m_produced.fetch_add(run, std::memory_order_relaxed);
+                if (first + run == m_capacity) continue;  // Puede quedar hueco al principio.
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stop) return;
+            m_sleeping.store(true);
+            // El tiempo límite cubre un aviso perdido entre la comprobación y la espera.
+            m_wake.wait_for(lock, std::chrono::milliseconds(50), [this] {
+                return m_stop || !m_sleeping.load() || level() < m_lowWatermark;
+            });
+            m_sleeping.store(false);
+            if (m_stop) return;
+        }
+    }
+
+    size_t m_itemSize;
+    size_t m_capacity = 0;
+    size_t m_mask = 0;
+    size_t m_lowWatermark = 0;
+    std::vector<uint8_t> m_data;                            ///< capacity casillas de itemSize bytes.
+    std::unique_ptr<std::atomic<uint64_t>[]> m_sequence;    ///< pos = libre para escribir; pos + 1 = lista para leer.
+
+    std::atomic<uint64_t> m_head{ 0 };  ///< Siguiente posición a consumir.
+    std::atomic<uint64_t> m_tail{ 0 };  ///< Siguiente posición a producir (solo la escribe el productor).
+
+    std::atomic<uint64_t> m_served{ 0 };
+    std::atomic<uint64_t> m_underflows{ 0 };
+    std::atomic<uint64_t> m_produced{ 0 };
+    std::atomic<uint64_t> m_wakeups{ 0 };
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_sleeping{ false };
+    bool m_stop = false;
+    std::thread m_producer;
+};
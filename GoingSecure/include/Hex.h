@@ -0,0 +1,188 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Simd.h"
+
+/**
+ * @class Hex
+ * @brief Codificador/decodificador hexadecimal sin flujos ni reservas intermedias.
+ *
+ * - encode() escribe exactamente 2 caracteres por byte en un búfer del llamador,
+ *   así que registrar claves, IVs o MACs no necesita reservar memoria.
+ * - Si la CPU tiene SSSE3 convierte 16 bytes por iteración (32 con AVX2): separa los nibbles
+ *   y los traduce con pshufb sobre una tabla de 16 caracteres.
+ * - El resto usa una tabla de 256 pares de caracteres construida en compilación.
+ */
+class Hex {
+public:
+    enum class Case {
+        Lower,
+        Upper
+    };
+
+    /**
+     * @brief Caracteres que produce encode() para n bytes.
+     */
+    static size_t encodedLength(size_t n) {
+        return 2 * n;
+    }
+
+    /**
+     * @brief Codifica n bytes en out (que debe tener encodedLength(n) caracteres).
+     * @return size_t Caracteres escritos.
+     */
+    static size_t encode(const uint8_t* in, size_t n, char* out, Case letterCase = Case::Lower) {
+        size_t i = 0;
+
+#if defined(GS_HAS_SSSE3)
+        const char* digits = letterCase == Case::Upper ? "0123456789ABCDEF" : "0123456789abcdef";
+#if defined(GS_HAS_AVX2)
+        if (gsCpuHasAvx2()) {
+            i = encodeAvx2(in, n, out, digits);
+        }
+#endif
+        if (gsCpuHasSsse3()) {
+            i += encodeSsse3(in + i, n - i, out + 2 * i, digits);
+        }
+#endif
+        const PairTable& pairs = letterCase == Case::Upper ? upperTable() : lowerTable();
+        for (; i < n; ++i) {
+            std::memcpy(out + 2 * i, pairs.chars + 2 * in[i], 2);
+        }
+        return 2 * n;
+    }
+
+    static std::string encode(const uint8_t* in, size_t n, Case letterCase = Case::Lower) {
+        std::string out(encodedLength(n), '\0');
+        if (n > 0) encode(in, n, &out[0], letterCase);
+        return out;
+    }
+
+    static std::string encode(const std::vector<uint8_t>& data, Case letterCase = Case::Lower) {
+        return encode(data.data(), data.size(), letterCase);
+    }
+
+    /**
+     * @brief Decodifica n caracteres (mayúsculas o minúsculas) en out (n / 2 bytes).
+     * @return size_t Bytes escritos.
+     * @throws std::runtime_error Si la longitud es impar o hay un carácter no hexadecimal.
+     */
+    static size_t decode(const char* in, size_t n, uint8_t* out) {
+        if (n % 2 != 0) {
+            throw std::runtime_error("Hex inválido (longitud impar).");
+        }
+        const DecodeTable& table = decodeTable();
+        for (size_t i = 0; i < n; i += 2) {
+            const uint8_t hi = table.value[static_cast<uint8_t>(in[i])];
+            const uint8_t lo = table.value[static_cast<uint8_t>(in[i + 1])];
+            if ((hi | lo) & 0xF0) {
+                throw std::runtime_error("Hex inválido (carácter no hexadecimal).");
+            }
+            out[i / 2] = static_cast<uint8_t>((hi << 4) | lo);
+        }
+        return n / 2;
+    }
+
+    static std::vector<uint8_t> decode(const std::string& text) {
+        std::vector<uint8_t> out(text.size() / 2);
+        decode(text.data(), text.size(), out.data());
+        return out;
+    }
+
+private:
+    /**
+     * @brief Los dos caracteres de cada byte, consecutivos.
+     */
+    struct PairTable {
+        char chars[512];
+    };
+
+    /**
+     * @brief Valor de cada carácter hexadecimal, o 0xFF si no lo es.
+     */
+    struct DecodeTable {
+        uint8_t value[256];
+    };
+
+    static constexpr PairTable makePairTable(char letterA) {
+        PairTable table{};
+        for (int b = 0; b < 256; ++b) {
+            const int hi = b >> 4;
+            const int lo = b & 0x0F;
+            table.chars[2 * b] = static_cast<char>(hi < 10 ? '0' + hi : letterA + hi - 10);
+            table.chars[2 * b + 1] = static_cast<char>(lo < 10 ? '0' + lo : letterA + lo - 10);
+        }
+        return table;
+    }
+
+    static constexpr DecodeTable makeDecodeTable() {
+        DecodeTable table{};
+        for (int c = 0; c < 256; ++c) table.value[c] = 0xFF;
+        for (int c = 0; c < 10; ++c) table.value['0' + c] = static_cast<uint8_t>(c);
+        for (int c = 0; c < 6; ++c) {
+            table.value['a' + c] = static_cast<uint8_t>(10 + c);
+            table.value['A' + c] = static_cast<uint8_t>(10 + c);
+        }
+        return table;
+    }
+
+    static const PairTable& lowerTable() {
+        static constexpr PairTable table = makePairTable('a');
+        return table;
+    }
+
+    static const PairTable& upperTable() {
+        static constexpr PairTable table = makePairTable('A');
+        return table;
+    }
+
+    static const DecodeTable& decodeTable() {
+        static constexpr DecodeTable table = makeDecodeTable();
+        return table;
+    }
+
+#if defined(GS_HAS_SSSE3)
+    /**
+     * @brief Bloques de 16 bytes -> 32 caracteres: nibbles alto y bajo traducidos con
+     * pshufb e intercalados.
+     * @return size_t Bytes procesados (múltiplo de 16).
+     */
+    GS_TARGET_SSSE3 static size_t encodeSsse3(const uint8_t* in, size_t n, char* out, const char* digits) {
+        const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits));
+        const __m128i mask = _mm_set1_epi8(0x0F);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            const __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+            const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+        return i;
+    }
+#endif
+
+#if defined(GS_HAS_AVX2)
+    /**
+     * @brief Bloques de 32 bytes -> 64 caracteres. El intercalado trabaja por carriles
+     * de 128 bits, así que se reordenan las mitades antes de guardar.
+     * @return size_t Bytes procesados (múltiplo de 32).
+     */
+    GS_TARGET_AVX2 static size_t encodeAvx2(const uint8_t* in, size_t n, char* out, const char* digits) {
+        const __m256i lut = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits)));
+        const __m256i mask = _mm256_set1_epi8(0x0F);
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+            const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+            const __m256i first = _mm256_unpacklo_epi8(hi, lo);   // bytes 0-7 | 16-23
+            const __m256i second = _mm256_unpackhi_epi8(hi, lo);  // bytes 8-15 | 24-31
+            char* o = out + 2 * i;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), _mm256_permute2x128_si256(first, second, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + 32), _mm256_permute2x128_si256(first, second, 0x31));
+        }
+        return i;
+    }
+#endif
+};
@@ -0,0 +1,140 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class MappedFile
+ * @brief Proyección en memoria de solo lectura de un archivo completo.
+ *
+ * Evita leer y parsear archivos grandes: el sistema operativo carga las páginas
+ * bajo demanda y las comparte entre procesos. Usa CreateFileMapping/MapViewOfFile
+ * en Windows y mmap en POSIX.
+ *
+ * @note Un archivo vacío se abre correctamente con data() == nullptr y size() == 0.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Proyecta el archivo indicado.
+     * @param path Ruta del archivo.
+     * @throws std::runtime_error Si el archivo no puede abrirse o proyectarse.
+     */
+    explicit MappedFile(const std::string& path) {
+        open(path);
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept {
+        swap(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Proyecta un archivo, cerrando antes la proyección actual si existe.
+     * @param path Ruta del archivo.
+     * @throws std::runtime_error Si el archivo no puede abrirse o proyectarse.
+     */
+    void open(const std::string& path) {
+        close();
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("No se pudo abrir el archivo: " + path);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            throw std::runtime_error("No se pudo obtener el tamaño de: " + path);
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+        if (m_size > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("No se pudo abrir el archivo: " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("No se pudo obtener el tamaño de: " + path);
+        }
+        m_size = static_cast<size_t>(info.st_size);
+        if (m_size > 0) {
+            void* view = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (view != MAP_FAILED) {
+                m_data = static_cast<const uint8_t*>(view);
+            }
+        }
+        ::close(fd);
+#endif
+        if (m_size > 0 && m_data == nullptr) {
+            m_size = 0;
+            throw std::runtime_error("No se pudo proyectar en memoria: " + path);
+        }
+    }
+
+    /**
+     * @brief Libera la proyección (no hace nada si no hay ninguna).
+     */
+    void close() {
+        if (m_data != nullptr) {
+#if defined(_WIN32)
+            UnmapViewOfFile(m_data);
+#else
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        }
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+private:
+    void swap(MappedFile& other) noexcept {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+    }
+
+    const uint8_t* m_data = nullptr;  ///< Inicio de la proyección.
+    size_t m_size = 0;                ///< Tamaño del archivo en bytes.
+};
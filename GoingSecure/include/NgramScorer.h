@@ -0,0 +1,175 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class NgramScorer
+ * @brief Puntuación incremental por n-gramas de un texto claro que cambia por columnas.
+ *
+ * Los solucionadores iterativos (recocido, ascenso de colinas) cambian un símbolo de
+ * la clave por paso, lo que en un cifrado periódico modifica una sola columna del
+ * texto claro (posiciones k, k+L, k+2L...). Volver a puntuar todo el texto en cada
+ * paso es casi todo el coste; este motor guarda el texto claro actual y su
+ * puntuación, y al cambiar una columna solo vuelve a sumar los n-gramas que tocan
+ * sus posiciones: O(N/L) en lugar de O(N).
+ *
+ * La puntuación es la suma de log-probabilidades de todas las ventanas de `order`
+ * símbolos consecutivos, con los símbolos en 0..alphabet-1 (26 para letras, 256
+ * para bytes). Sirve igual para Vigenère con cuatrigramas (QuadgramTable) que para
+ * XOR con bigramas de bytes.
+ *
+ * Uso típico:
+ * @code
+ * NgramScorer scorer(table.data(), 26, 4);
+ * scorer.reset(plain.data(), plain.size());
+ * double delta = scorer.updateColumn(k, L, newColumn.data());
+ * if (delta < 0) scorer.undo();
+ * @endcode
+ */
+class NgramScorer {
+public:
+    /**
+     * @param logProbs Tabla de alphabet^order log-probabilidades (debe vivir mientras se use).
+     * @param alphabet Número de símbolos distintos.
+     * @param order Longitud de los n-gramas.
+     * @throws std::invalid_argument Si la tabla es nula o alphabet/order son 0.
+     */
+    NgramScorer(const float* logProbs, unsigned int alphabet, unsigned int order)
+        : m_table(logProbs), m_alphabet(alphabet), m_order(order) {
+        if (logProbs == nullptr || alphabet == 0 || order == 0) {
+            throw std::invalid_argument("Tabla de n-gramas inválida.");
+        }
+        for (unsigned int t = 1; t < order; ++t) m_leading *= alphabet;
+    }
+
+    ~NgramScorer() = default;
+
+    /**
+     * @brief Carga un texto claro completo y lo puntúa desde cero.
+     * @param plain Símbolos en 0..alphabet-1.
+     * @param length Número de símbolos.
+     */
+    void reset(const uint8_t* plain, size_t length) {
+        m_plain.assign(plain, plain + length);
+        m_undoSymbols.clear();
+        m_lastDelta = 0.0;
+        m_canUndo = false;
+        m_score = rangeScore(0, windowCount());
+    }
+
+    /**
+     * @brief Suma de los n-gramas que contienen alguna posición de la columna k.
+     *
+     * Con period >= order las ventanas de dos posiciones de la columna no se solapan;
+     * con un periodo menor toda ventana toca la columna y se suma el texto entero.
+     */
+    double columnScore(size_t k, size_t period) const {
+        const size_t windows = windowCount();
+        if (windows == 0) return 0.0;
+        if (period < m_order) return rangeScore(0, windows);
+
+        double total = 0.0;
+        for (size_t j = k; j < m_plain.size(); j += period) {
+            size_t first = j + 1 >= m_order ? j + 1 - m_order : 0;
+            size_t last = std::min(j + 1, windows);
+            total += rangeScore(first, last);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Sustituye la columna k y actualiza la puntuación.
+     *
+     * @param k Columna (0..period-1).
+     * @param period Longitud de la clave.
+     * @param symbols Nuevos símbolos de la columna, uno por posición k, k+period...
+     * @return double Cambio de la puntuación (ya aplicado a score()).
+     */
+    double updateColumn(size_t k, size_t period, const uint8_t* symbols) {
+        const double before = columnScore(k, period);
+        m_undoSymbols.clear();
+        size_t t = 0;
+        for (size_t j = k; j < m_plain.size(); j += period, ++t) {
+            m_undoSymbols.push_back(m_plain[j]);
+            m_plain[j] = symbols[t];
+        }
+        m_undoColumn = k;
+        m_undoPeriod = period;
+        m_lastDelta = columnScore(k, period) - before;
+        m_canUndo = true;
+        m_score += m_lastDelta;
+        return m_lastDelta;
+    }
+
+    /**
+     * @brief Deshace el último updateColumn() (sin volver a puntuar).
+     * @throws std::logic_error Si no hay cambio que deshacer.
+     */
+    void undo() {
+        if (!m_canUndo) {
+            throw std::logic_error("No hay cambio de columna que deshacer.");
+        }
+        size_t t = 0;
+        for (size_t j = m_undoColumn; j < m_plain.size(); j += m_undoPeriod, ++t) {
+            m_plain[j] = m_undoSymbols[t];
+        }
+        m_score -= m_lastDelta;
+        m_canUndo = false;
+    }
+
+    /**
+     * @brief Vuelve a puntuar todo el texto para descartar el error acumulado de los deltas.
+     */
+    double rescore() {
+        m_score = rangeScore(0, windowCount());
+        return m_score;
+    }
+
+    double score() const { return m_score; }
+    const std::vector<uint8_t>& plain() const { return m_plain; }
+    size_t size() const { return m_plain.size(); }
+
+    /**
+     * @brief Número de posiciones de la columna k con un periodo dado.
+     */
+    size_t columnLength(size_t k, size_t period) const {
+        return k < m_plain.size() ? (m_plain.size() - k + period - 1) / period : 0;
+    }
+
+private:
+    size_t windowCount() const {
+        return m_plain.size() >= m_order ? m_plain.size() - m_order + 1 : 0;
+    }
+
+    /**
+     * @brief Suma de las ventanas que empiezan en [first, last).
+     *
+     * El índice de cada ventana se obtiene del anterior quitando el primer símbolo
+     * y añadiendo el siguiente.
+     */
+    double rangeScore(size_t first, size_t last) const {
+        if (first >= last) return 0.0;
+        const uint8_t* p = m_plain.data();
+        size_t index = 0;
+        for (unsigned int t = 0; t < m_order; ++t) index = index * m_alphabet + p[first + t];
+
+        double total = m_table[index];
+        for (size_t s = first + 1; s < last; ++s) {
+            index = (index - p[s - 1] * m_leading) * m_alphabet + p[s + m_order - 1];
+            total += m_table[index];
+        }
+        return total;
+    }
+
+    const float* m_table;               ///< alphabet^order log-probabilidades.
+    unsigned int m_alphabet;            ///< Símbolos distintos.
+    unsigned int m_order;               ///< Longitud de los n-gramas.
+    size_t m_leading = 1;               ///< alphabet^(order-1), peso del primer símbolo.
+    std::vector<uint8_t> m_plain;       ///< Texto claro actual.
+    double m_score = 0.0;               ///< Puntuación actual.
+
+    std::vector<uint8_t> m_undoSymbols; ///< Columna anterior al último cambio.
+    size_t m_undoColumn = 0;
+    size_t m_undoPeriod = 1;
+    double m_lastDelta = 0.0;
+    bool m_canUndo = false;
+};
@@ -0,0 +1,426 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Simd.h"
+#include "MappedFile.h"
+
+/**
+ * @class PasswordAuditor
+ * @brief Audita volcados de contraseñas (una por línea) contra una política.
+ *
+ * El archivo se proyecta en memoria y se reparte en tramos entre hilos; cada tramo
+ * empieza en un inicio de línea. Los bytes se clasifican de 64 en 64 con
+ * comparaciones de rango SIMD (SSE2, o AVX2 si la CPU lo tiene), que producen una máscara de bits por
+ * clase (mayúscula, minúscula, dígito, imprimible, salto de línea); los conteos de
+ * cada línea salen de popcount sobre esas máscaras, sin mirar byte a byte.
+ *
+ * Las clases son ASCII y no dependen del locale: símbolo es cualquier carácter
+ * imprimible 0x21..0x7E que no sea letra ni dígito (lo mismo que std::ispunct en el
+ * locale "C"); "otro" es el resto (espacio, controles, bytes >= 0x80). Un '\r'
+ * antes del salto de línea no cuenta como parte de la contraseña.
+ */
+class PasswordAuditor {
+public:
+    /**
+     * @brief Reglas que puede incumplir una contraseña (se combinan como bits).
+     */
+    enum Rule : uint32_t {
+        TooShort = 1u << 0,
+        TooLong = 1u << 1,
+        MissingUpper = 1u << 2,
+        MissingLower = 1u << 3,
+        MissingDigit = 1u << 4,
+        MissingSymbol = 1u << 5,
+        TooFewClasses = 1u << 6,
+        ForbiddenCharacter = 1u << 7
+    };
+
+    static const size_t kRuleCount = 8;
+    static const size_t kLengthBuckets = 65;  ///< Longitudes 0..63 y una cubeta para >= 64.
+
+    /**
+     * @brief Política configurable. Por defecto equivale a CryptoGenerator::validatePassword.
+     */
+    struct Policy {
+        size_t minLength = 8;
+        size_t maxLength = 0;           ///< 0 = sin límite.
+        unsigned int minUpper = 1;
+        unsigned int minLower = 1;
+        unsigned int minDigits = 1;
+        unsigned int minSymbols = 1;
+        unsigned int minClasses = 0;    ///< Clases distintas (de 4) presentes como mínimo.
+        bool allowOther = true;         ///< Admitir espacios, controles y bytes no ASCII.
+    };
+
+    /**
+     * @brief Conteo de clases de una contraseña.
+     */
+    struct Counts {
+        size_t length = 0;
+        size_t upper = 0;
+        size_t lower = 0;
+        size_t digits = 0;
+        size_t symbols = 0;
+        size_t other = 0;
+    };
+
+    /**
+     * @brief Línea que incumple la política.
+     */
+    struct Failure {
+        uint64_t offset;    ///< Desplazamiento en bytes del inicio de la línea.
+        uint64_t line;      ///< Número de línea (desde 1).
+        uint32_t length;    ///< Longitud de la contraseña (sin '\r').
+        uint32_t rules;     ///< Reglas incumplidas (combinación de Rule).
+    };
+
+    /**
+     * @brief Estadísticas agregadas.
+     */
+    struct Stats {
+        uint64_t audited = 0;       ///< Líneas no vacías evaluadas.
+        uint64_t emptyLines = 0;    ///< Líneas vacías (no se evalúan).
+        uint64_t passed = 0;
+        uint64_t failed = 0;
+        uint64_t totalLength = 0;
+        std::array<uint64_t, kRuleCount> byRule{};      ///< Incumplimientos de cada regla.
+        std::array<uint64_t, kLengthBuckets> lengths{}; ///< Histograma de longitudes.
+
+        void merge(const Stats& other) {
+            audited += other.audited;
+            emptyLines += other.emptyLines;
+            passed += other.passed;
+            failed += other.failed;
+            totalLength += other.totalLength;
+            for (size_t r = 0; r < kRuleCount; ++r) byRule[r] += other.byRule[r];
+            for (size_t b = 0; b < kLengthBuckets; ++b) lengths[b] += other.lengths[b];
+        }
+    };
+
+    struct Report {
+        Stats stats;
+        std::vector<Failure> failures;  ///< Ordenadas por desplazamiento.
+        bool failuresTruncated = false; ///< Se alcanzó maxFailures.
+    };
+
+    PasswordAuditor() = default;
+
+    explicit PasswordAuditor(const Policy& policy) : m_policy(policy) {}
+
+    ~PasswordAuditor() = default;
+
+    /**
+     * @brief Reglas incumplidas por un conteo de clases (0 = cumple).
+     */
+    uint32_t evaluate(const Counts& c) const {
+        uint32_t rules = 0;
+        if (c.length < m_policy.minLength) rules |= TooShort;
+        if (m_policy.maxLength != 0 && c.length > m_policy.maxLength) rules |= TooLong;
+        if (c.upper < m_policy.minUpper) rules |= MissingUpper;
+        if (c.lower < m_policy.minLower) rules |= MissingLower;
+        if (c.digits < m_policy.minDigits) rules |= MissingDigit;
+        if (c.symbols < m_policy.minSymbols) rules |= MissingSymbol;
+        if (m_policy.minClasses != 0) {
+            const unsigned int classes = (c.upper > 0) + (c.lower > 0) + (c.digits > 0) + (c.symbols > 0);
+            if (classes < m_policy.minClasses) rules |= TooFewClasses;
+        }
+        if (!m_policy.allowOther && c.other > 0) rules |= ForbiddenCharacter;
+        return rules;
+    }
+
+    /**
+     * @brief Clasifica los caracteres de una contraseña.
+     */
+    static Counts count(const char* password, size_t length) {
+        Counts c;
+        c.length = length;
+        for (size_t i = 0; i < length; ++i) {
+            const unsigned int b = static_cast<uint8_t>(password[i]);
+            if (b - 'A' < 26u) c.upper++;
+            else if (b - 'a' < 26u) c.lower++;
+            else if (b - '0' < 10u) c.digits++;
+            else if (b - 0x21u < 0x5Eu) c.symbols++;
+            else c.other++;
+        }
+        return c;
+    }
+
+    /**
+     * @brief Reglas incumplidas por una contraseña (0 = cumple).
+     */
+    uint32_t check(const std::string& password) const {
+        return evaluate(count(password.data(), password.size()));
+    }
+
+    /**
+     * @brief Audita un bloque de texto con una contraseña por línea.
+     *
+     * @param threads Hilos a usar (0 = todos los núcleos).
+     * @param maxFailures Máximo de líneas fallidas a devolver (las estadísticas las cuentan todas).
+     */
+    Report audit(const uint8_t* data, size_t size, unsigned int threads = 0,
+        size_t maxFailures = 1u << 20) const {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        // Al menos 1 MB por hilo; por debajo no compensa crearlo.
+        const size_t maxThreads = std::max<size_t>(1, size / (1u << 20));
+        if (threads > maxThreads) threads = static_cast<unsigned int>(maxThreads);
+
+        // Cada tramo empieza justo después de un salto de línea.
+        std::vector<size_t> bounds(threads + 1, size);
+        bounds[0] = 0;
+        for (unsigned int t = 1; t < threads; ++t) {
+            size_t start = std::max(bounds[t - 1], size / threads * t);
+            while (start < size && start > 0 && data[start - 1] != '\n') ++start;
+            bounds[t] = start;
+        }
+
+        std::vector<Partial> partials(threads);
+        if (threads == 1) {
+            scanRange(data, 0, size, maxFailures, partials[0]);
+        }
+        else {
+            std::vector<std::thread> workers;
+            for (unsigned int t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    scanRange(data, bounds[t], bounds[t + 1], maxFailures, partials[t]);
+                });
+            }
+            for (auto& worker : workers) worker.join();
+        }
+
+        Report report;
+        uint64_t lineBase = 0;
+        for (auto& partial : partials) {
+            report.stats.merge(partial.stats);
+            report.failuresTruncated |= partial.truncated;
+            for (auto& failure : partial.failures) {
+                if (report.failures.size() == maxFailures) {
+                    report.failuresTruncated = true;
+                    break;
+                }
+                failure.line += lineBase;
+                report.failures.push_back(failure);
+            }
+            lineBase += partial.lines;
+        }
+        return report;
+    }
+
+    Report audit(const std::string& text, unsigned int threads = 0, size_t maxFailures = 1u << 20) const {
+        return audit(reinterpret_cast<const uint8_t*>(text.data()), text.size(), threads, maxFailures);
+    }
+
+    /**
+     * @brief Audita un archivo proyectándolo en memoria (sin copiarlo).
+     * @throws std::runtime_error Si el archivo no puede abrirse.
+     */
+    Report auditFile(const std::string& path, unsigned int threads = 0, size_t maxFailures = 1u << 20) const {
+        MappedFile file(path);
+        return audit(file.data(), file.size(), threads, maxFailures);
+    }
+
+    /**
+     * @brief Nombre legible de una regla.
+     */
+    static const char* ruleName(size_t index) {
+        static const char* const names[kRuleCount] = {
+            "demasiado corta", "demasiado larga", "sin mayúsculas", "sin minúsculas",
+            "sin dígitos", "sin símbolos", "pocas clases de carácter", "carácter no permitido"
+        };
+        return index < kRuleCount ? names[index] : "";
+    }
+
+    const Policy& policy() const { return m_policy; }
+
+private:
+    /**
+     * @brief Resultado de un tramo.
+     */
+    struct Partial {
+        Stats stats;
+        std::vector<Failure> failures;
+        uint64_t lines = 0;     ///< Líneas del tramo (incluidas las vacías).
+        bool truncated = false;
+    };
+
+    /**
+     * @brief Máscaras de clase de 64 bytes consecutivos (bit i = byte i).
+     */
+    struct Masks {
+        uint64_t upper;
+        uint64_t lower;
+        uint64_t digit;
+        uint64_t printable;
+        uint64_t newline;
+    };
+
+    /**
+     * @brief Clasifica 64 bytes; avx2 es gsCpuHasAvx2(), consultado una vez por tramo.
+     */
+    static void classify(const uint8_t* p, Masks& m, bool avx2) {
+#if defined(GS_HAS_AVX2)
+        if (avx2) {
+            classifyAvx2(p, m);
+            return;
+        }
+#endif
+#if defined(GS_HAS_SSE2)
+        m = Masks{ 0, 0, 0, 0, 0 };
+        for (int q = 0; q < 4; ++q) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * q));
+            const int shift = 16 * q;
+            m.upper |= static_cast<uint64_t>(_mm_movemask_epi8(inRange128(v, 'A', 'Z'))) << shift;
+            m.lower |= static_cast<uint64_t>(_mm_movemask_epi8(inRange128(v, 'a', 'z'))) << shift;
+            m.digit |= static_cast<uint64_t>(_mm_movemask_epi8(inRange128(v, '0', '9'))) << shift;
+            m.printable |= static_cast<uint64_t>(_mm_movemask_epi8(inRange128(v, 0x21, 0x7E))) << shift;
+            m.newline |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')))) << shift;
+        }
+#else
+        (void)avx2;
+        m = Masks{ 0, 0, 0, 0, 0 };
+        for (int i = 0; i < 64; ++i) {
+            const unsigned int b = p[i];
+            const uint64_t bit = 1ull << i;
+            if (b - 'A' < 26u) m.upper |= bit;
+            if (b - 'a' < 26u) m.lower |= bit;
+            if (b - '0' < 10u) m.digit |= bit;
+            if (b - 0x21u < 0x5Eu) m.printable |= bit;
+            if (b == '\n') m.newline |= bit;
+        }
+#endif
+    }
+
+#if defined(GS_HAS_AVX2)
+    GS_TARGET_AVX2 static void classifyAvx2(const uint8_t* p, Masks& m) {
+        uint32_t upper[2], lower[2], digit[2], printable[2], newline[2];
+        for (int h = 0; h < 2; ++h) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * h));
+            upper[h] = static_cast<uint32_t>(_mm256_movemask_epi8(inRange256(v, 'A', 'Z')));
+            lower[h] = static_cast<uint32_t>(_mm256_movemask_epi8(inRange256(v, 'a', 'z')));
+            digit[h] = static_cast<uint32_t>(_mm256_movemask_epi8(inRange256(v, '0', '9')));
+            printable[h] = static_cast<uint32_t>(_mm256_movemask_epi8(inRange256(v, 0x21, 0x7E)));
+            newline[h] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+        }
+        m.upper = upper[0] | (static_cast<uint64_t>(upper[1]) << 32);
+        m.lower = lower[0] | (static_cast<uint64_t>(lower[1]) << 32);
+        m.digit = digit[0] | (static_cast<uint64_t>(digit[1]) << 32);
+        m.printable = printable[0] | (static_cast<uint64_t>(printable[1]) << 32);
+        m.newline = newline[0] | (static_cast<uint64_t>(newline[1]) << 32);
+    }
+
+    /**
+     * @brief 0xFF en los bytes dentro de [lo, hi]: se desplaza el rango para que
+     * empiece en -128 y basta una comparación con signo.
+     */
+    GS_TARGET_AVX2 static __m256i inRange256(__m256i v, int lo, int hi) {
+        const __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(0x80 - lo)));
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + (hi - lo) + 1)), shifted);
+    }
+#endif
+
+#if defined(GS_HAS_SSE2)
+    static __m128i inRange128(__m128i v, int lo, int hi) {
+        const __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - lo)));
+        return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + (hi - lo) + 1)));
+    }
+#endif
+
+    /**
+     * @brief Suma a la línea actual los bytes de las posiciones marcadas en seg.
+     */
+    static void accumulate(const Masks& m, uint64_t seg, Counts& line) {
+        const size_t upper = static_cast<size_t>(gsPopcount64(m.upper & seg));
+        const size_t lower = static_cast<size_t>(gsPopcount64(m.lower & seg));
+        const size_t digits = static_cast<size_t>(gsPopcount64(m.digit & seg));
+        const size_t printable = static_cast<size_t>(gsPopcount64(m.printable & seg));
+        const size_t length = static_cast<size_t>(gsPopcount64(seg));
+        line.length += length;
+        line.upper += upper;
+        line.lower += lower;
+        line.digits += digits;
+        line.symbols += printable - upper - lower - digits;
+        line.other += length - printable;
+    }
+
+    /**
+     * @brief Cierra la línea [start, end) ya contada en line.
+     */
+    void finishLine(const uint8_t* data, uint64_t start, uint64_t end, Counts& line,
+        size_t maxFailures, Partial& out) const {
+        out.lines++;
+        if (line.length > 0 && data[end - 1] == '\r') {
+            line.length--;
+            line.other--;
+        }
+        if (line.length == 0) {
+            out.stats.emptyLines++;
+        }
+        else {
+            const uint32_t rules = evaluate(line);
+            out.stats.audited++;
+            out.stats.totalLength += line.length;
+            out.stats.lengths[line.length < kLengthBuckets - 1 ? line.length : kLengthBuckets - 1]++;
+            // Sin saltos por regla: el resultado de cada línea es poco predecible.
+            out.stats.failed += rules != 0;
+            for (size_t r = 0; r < kRuleCount; ++r) {
+                out.stats.byRule[r] += (rules >> r) & 1u;
+            }
+            if (rules != 0) {
+                if (out.failures.size() < maxFailures) {
+                    out.failures.push_back(Failure{ start, out.lines,
+                        static_cast<uint32_t>(line.length), rules });
+                }
+                else {
+                    out.truncated = true;
+                }
+            }
+        }
+        line = Counts();
+    }
+
+    /**
+     * @brief Recorre [begin, end), que empieza en un inicio de línea.
+     */
+    void scanRange(const uint8_t* data, size_t begin, size_t end, size_t maxFailures, Partial& out) const {
+        Counts line;
+        uint64_t lineStart = begin;
+        uint8_t tail[64];
+        const bool avx2 = gsCpuHasAvx2();
+
+        for (size_t pos = begin; pos < end; pos += 64) {
+            const size_t avail = end - pos < 64 ? end - pos : 64;
+            Masks m;
+            if (avail == 64) {
+                classify(data + pos, m, avx2);
+            }
+            else {
+                std::memset(tail, 0, sizeof(tail));
+                std::memcpy(tail, data + pos, avail);
+                classify(tail, m, avx2);
+            }
+            const uint64_t valid = avail == 64 ? ~0ull : (1ull << avail) - 1;
+            uint64_t newlines = m.newline & valid;
+            size_t segStart = 0;
+
+            while (newlines != 0) {
+                const size_t bit = static_cast<size_t>(gsCountTrailingZeros64(newlines));
+                const uint64_t below = (1ull << bit) - 1;
+                const uint64_t fromStart = segStart < 64 ? ~((1ull << segStart) - 1) : 0;
+                accumulate(m, below & fromStart, line);
+                finishLine(data, lineStart, pos + bit, line, maxFailures, out);
+                lineStart = pos + bit + 1;
+                segStart = bit + 1;
+                newlines &= newlines - 1;
+            }
+            if (segStart < avail) {
+                accumulate(m, valid & ~((1ull << segStart) - 1), line);
+            }
+        }
+        // Última línea sin salto final.
+        if (lineStart < end) {
+            finishLine(data, lineStart, end, line, maxFailures, out);
+        }
+        out.stats.passed = out.stats.audited - out.stats.failed;
+    }
+
+    Policy m_policy;
+};
@@ -0,0 +1,196 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "RandomPool.h"
+
+/**
+ * @class PasswordArena
+ * @brief Bloque contiguo con N contraseñas de longitud L (sin separadores).
+ *
+ * La contraseña i ocupa los caracteres [i * L, (i + 1) * L). Guardarlas juntas evita
+ * una reserva por contraseña al generar millones de credenciales de un solo uso.
+ */
+class PasswordArena {
+public:
+    PasswordArena() = default;
+
+    /**
+     * @throws std::invalid_argument Si count * length no cabe en size_t.
+     */
+    PasswordArena(size_t count, size_t length)
+        : m_data(totalSize(count, length)), m_count(count), m_length(length) {}
+
+    ~PasswordArena() {
+        wipe();
+    }
+
+    PasswordArena(PasswordArena&& other) noexcept
+        : m_data(std::move(other.m_data)), m_count(other.m_count), m_length(other.m_length) {
+        other.m_data.clear();
+        other.m_count = 0;
+        other.m_length = 0;
+    }
+
+    /**
+     * @brief Borra las contraseñas actuales antes de quedarse con las de other.
+     */
+    PasswordArena& operator=(PasswordArena&& other) noexcept {
+        if (this != &other) {
+            wipe();
+            m_data = std::move(other.m_data);
+            m_count = other.m_count;
+            m_length = other.m_length;
+            other.m_data.clear();
+            other.m_count = 0;
+            other.m_length = 0;
+        }
+        return *this;
+    }
+
+    PasswordArena(const PasswordArena&) = delete;
+    PasswordArena& operator=(const PasswordArena&) = delete;
+
+    /**
+     * @brief Inicio de la contraseña i (L caracteres, sin terminador).
+     */
+    const char* password(size_t i) const { return m_data.data() + i * m_length; }
+
+    /**
+     * @brief Copia de la contraseña i como std::string.
+     */
+    std::string str(size_t i) const { return std::string(password(i), m_length); }
+
+    size_t size() const { return m_count; }
+    size_t length() const { return m_length; }
+    char* data() { return m_data.data(); }
+    const char* data() const { return m_data.data(); }
+
+    /**
+     * @brief Sobrescribe con ceros todas las contraseñas.
+     */
+    void wipe() {
+        volatile char* p = m_data.data();
+        for (size_t i = 0; i < m_data.size(); ++i) p[i] = 0;
+    }
+
+    /**
+     * @brief count * length, comprobando que no se desborde.
+     * @throws std::invalid_argument Si el producto no cabe en size_t.
+     */
+    static size_t totalSize(size_t count, size_t length) {
+        if (length != 0 && count > std::numeric_limits<size_t>::max() / length) {
+            throw std::invalid_argument("Demasiadas contraseñas para la longitud pedida.");
+        }
+        return count * length;
+    }
+
+private:
+    std::vector<char> m_data;
+    size_t m_count = 0;
+    size_t m_length = 0;
+};
+
+/**
+ * @class PasswordBatch
+ * @brief Genera contraseñas en lote con muestreo acotado sin sesgo y sin divisiones.
+ *
+ * El alfabeto se valida y se prepara una sola vez. Cada carácter se elige con el
+ * método de Lemire: un entero aleatorio x de 16 bits se multiplica por el tamaño s
+ * del alfabeto; los 16 bits altos del producto son el índice y los bajos deciden si
+ * hay que rechazar x (menos de 65536 % s casos de 65536, < 0,4 % para s <= 256).
+ * El umbral se calcula en el constructor, así que el bucle no divide nunca.
+ *
+ * Los números aleatorios se piden a RandomPool por bloques; en modo paralelo cada
+ * hilo llena su parte del arena con el generador ChaCha20 de su propio hilo.
+ */
+class PasswordBatch {
+public:
+    /**
+     * @param alphabet Caracteres permitidos (1 a 256; se admiten repetidos).
+     * @throws std::invalid_argument Si el alfabeto está vacío o tiene más de 256 caracteres.
+     */
+    explicit PasswordBatch(const std::string& alphabet)
+        : m_alphabet(alphabet), m_size(static_cast<uint32_t>(alphabet.size())) {
+        if (alphabet.empty() || alphabet.size() > 256) {
+            throw std::invalid_argument("El alfabeto debe tener entre 1 y 256 caracteres.");
+        }
+        m_threshold = static_cast<uint32_t>(65536u % m_size);
+    }
+
+    ~PasswordBatch() = default;
+
+    /**
+     * @brief Genera count contraseñas de length caracteres.
+     *
+     * @param threads Hilos a usar (0 = todos los núcleos, 1 = sin hilos extra).
+     * @return PasswordArena Contraseñas contiguas.
+     * @throws std::invalid_argument Si count * length no cabe en size_t.
+     */
+    PasswordArena generate(size_t count, size_t length, unsigned int threads = 1) const {
+        const size_t total = PasswordArena::totalSize(count, length);
+        PasswordArena arena(count, length);
+        if (total == 0) return arena;
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        // Al menos 64 KB de salida por hilo; por debajo no compensa crearlo.
+        const size_t maxThreads = std::max<size_t>(1, total / (64 * 1024));
+        if (threads > maxThreads) threads = static_cast<unsigned int>(maxThreads);
+
+        if (threads == 1) {
+            fill(arena.data(), total);
+            return arena;
+        }
+
+        // Se reparten contraseñas completas para que ninguna quede entre dos hilos.
+        std::vector<std::thread> workers;
+        const size_t perThread = (count + threads - 1) / threads;
+        for (unsigned int t = 0; t < threads; ++t) {
+            const size_t first = t * perThread;
+            if (first >= count) break;
+            const size_t last = std::min(count, first + perThread);
+            char* out = arena.data() + first * length;
+            workers.emplace_back([this, out, first, last, length] {
+                fill(out, (last - first) * length);
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        return arena;
+    }
+
+    /**
+     * @brief Escribe length caracteres aleatorios del alfabeto en out (hilo actual).
+     */
+    void fill(char* out, size_t length) const {
+        const char* alphabet = m_alphabet.data();
+        uint16_t words[kWords];
+        size_t available = 0;
+        size_t next = 0;
+        size_t used = 0;
+
+        for (size_t i = 0; i < length; ++i) {
+            uint32_t product;
+            do {
+                if (next == available) {
+                    const size_t need = (length - i) + (length - i) / 64 + 1;
+                    available = need < kWords ? need : kWords;
+                    if (available > used) used = available;
+                    RandomPool::fill(reinterpret_cast<uint8_t*>(words), available * sizeof(uint16_t));
+                    next = 0;
+                }
+                product = static_cast<uint32_t>(words[next++]) * m_size;
+            } while ((product & 0xFFFFu) < m_threshold);
+            out[i] = alphabet[product >> 16];
+        }
+        // Solo se borran las palabras que llegaron a llenarse.
+        volatile uint16_t* w = words;
+        for (size_t k = 0; k < used; ++k) w[k] = 0;
+    }
+
+    const std::string& alphabet() const { return m_alphabet; }
+
+private:
+    static const size_t kWords = 2048;  ///< Palabras de 16 bits pedidas por bloque (4 KB).
+
+    std::string m_alphabet;
+    uint32_t m_size;        ///< Caracteres del alfabeto (s).
+    uint32_t m_threshold;   ///< 65536 % s: valores bajos del producto que se rechazan.
+};
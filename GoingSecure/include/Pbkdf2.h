@@ -0,0 +1,237 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Sha256.h"
+#include "SecureArena.h"
+
+/**
+ * @class Pbkdf2
+ * @brief Derivación de claves PBKDF2-HMAC-SHA256 (RFC 8018) con varias derivaciones por registro.
+ *
+ * Cada bloque de salida de cada derivación es una cadena independiente de
+ * `iterations` HMAC; deriveBatch() las reparte en carriles SIMD (8 si la CPU tiene
+ * AVX2, 4 con SSE2) y las avanza juntas. El HMAC de cada iteración cuesta dos
+ * compresiones de un bloque: los estados tras clave ^ ipad y clave ^ opad se
+ * calculan una sola vez.
+ *
+ * Uso típico con una salt de CryptoGenerator::generateSalt:
+ * @code
+ * std::vector<uint8_t> salt = gen.generateSalt(16);
+ * std::vector<uint8_t> key = Pbkdf2::derive(password, salt, 600000, 32);
+ * @endcode
+ */
+class Pbkdf2 {
+public:
+    /**
+     * @brief Una derivación: contraseña, salt y destino.
+     */
+    struct Job {
+        const uint8_t* password;
+        size_t passwordLength;
+        const uint8_t* salt;
+        size_t saltLength;
+        uint8_t* out;
+        size_t outLength;
+    };
+
+    /**
+     * @brief Carriles que avanzan a la vez en esta compilación y esta CPU.
+     */
+    static size_t lanes() {
+#if defined(GS_HAS_AVX2_LANES)
+        if (gsCpuHasAvx2()) return Sha256::Lane8::width;
+#endif
+#if defined(GS_HAS_SSE2)
+        return Sha256::Lane4::width;
+#else
+        return Sha256::Lane1::width;
+#endif
+    }
+
+    /**
+     * @brief Ejecuta varias derivaciones con el mismo número de iteraciones.
+     * @throws std::invalid_argument Si iterations es 0 o un destino es nulo.
+     */
+    static void deriveBatch(const Job* jobs, size_t count, uint32_t iterations) {
+        if (iterations == 0) {
+            throw std::invalid_argument("PBKDF2 necesita al menos una iteración.");
+        }
+        std::vector<Task> tasks;
+        for (size_t j = 0; j < count; ++j) {
+            if (jobs[j].out == nullptr && jobs[j].outLength > 0) {
+                throw std::invalid_argument("Destino PBKDF2 nulo.");
+            }
+            const size_t blocks = (jobs[j].outLength + Sha256::kDigestSize - 1) / Sha256::kDigestSize;
+            for (size_t b = 0; b < blocks; ++b) tasks.push_back(Task{ &jobs[j], static_cast<uint32_t>(b + 1) });
+        }
+
+        const size_t width = lanes();
+        for (size_t i = 0; i < tasks.size(); i += width) {
+            const size_t n = std::min(width, tasks.size() - i);
+#if defined(GS_HAS_AVX2_LANES)
+            if (width == Sha256::Lane8::width) {
+                run<Sha256::Lane8>(tasks.data() + i, n, iterations);
+                continue;
+            }
+#endif
+#if defined(GS_HAS_SSE2)
+            run<Sha256::Lane4>(tasks.data() + i, n, iterations);
+#else
+            run<Sha256::Lane1>(tasks.data() + i, n, iterations);
+#endif
+        }
+    }
+
+    /**
+     * @brief Una derivación (sus bloques de salida también se reparten en carriles).
+     */
+    static void derive(const uint8_t* password, size_t passwordLength,
+        const uint8_t* salt, size_t saltLength, uint32_t iterations,
+        uint8_t* out, size_t outLength) {
+        const Job job{ password, passwordLength, salt, saltLength, out, outLength };
+        deriveBatch(&job, 1, iterations);
+    }
+
+    static std::vector<uint8_t> derive(const std::string& password, const std::vector<uint8_t>& salt,
+        uint32_t iterations, size_t outLength) {
+        std::vector<uint8_t> key(outLength);
+        derive(reinterpret_cast<const uint8_t*>(password.data()), password.size(),
+            salt.data(), salt.size(), iterations, key.data(), key.size());
+        return key;
+    }
+
+private:
+    /**
+     * @brief Un bloque de salida de una derivación.
+     */
+    struct Task {
+        const Job* job;
+        uint32_t block;     ///< Índice del bloque (desde 1, como INT(i) en el RFC).
+    };
+
+    /**
+     * @brief Estados HMAC precalculados tras el bloque clave ^ ipad y clave ^ opad.
+     */
+    static void hmacStates(const Job& job, uint32_t inner[8], uint32_t outer[8]) {
+        uint8_t key[Sha256::kBlockSize] = { 0 };
+        if (job.passwordLength > Sha256::kBlockSize) {
+            Sha256::hash(job.password, job.passwordLength, key);
+        }
+        else if (job.passwordLength > 0) {
+            std::memcpy(key, job.password, job.passwordLength);
+        }
+        uint8_t pad[Sha256::kBlockSize];
+        Sha256 sha;
+        for (size_t i = 0; i < Sha256::kBlockSize; ++i) pad[i] = key[i] ^ 0x36;
+        sha.update(pad, sizeof(pad));
+        std::memcpy(inner, sha.state(), 8 * sizeof(uint32_t));
+        sha.reset();
+        for (size_t i = 0; i < Sha256::kBlockSize; ++i) pad[i] = key[i] ^ 0x5C;
+        sha.update(pad, sizeof(pad));
+        std::memcpy(outer, sha.state(), 8 * sizeof(uint32_t));
+        SecureArena::wipe(key, sizeof(key));
+        SecureArena::wipe(pad, sizeof(pad));
+    }
+
+    /**
+     * @brief U1 = HMAC(P, S || INT(block)), con los estados ya precalculados.
+     */
+    static void firstBlock(const Job& job, uint32_t block, const uint32_t inner[8],
+        const uint32_t outer[8], uint32_t u[8]) {
+        uint8_t counter[4];
+        Sha256::storeBigEndian(counter, block);
+        uint8_t digest[Sha256::kDigestSize];
+        Sha256 sha;
+        sha.resume(inner, Sha256::kBlockSize);
+        if (job.saltLength > 0) sha.update(job.salt, job.saltLength);
+        sha.update(counter, sizeof(counter));
+        sha.finish(digest);
+        sha.resume(outer, Sha256::kBlockSize);
+        sha.update(digest, sizeof(digest));
+        sha.finish(digest);
+        for (int i = 0; i < 8; ++i) u[i] = Sha256::loadBigEndian(digest + 4 * i);
+        SecureArena::wipe(digest, sizeof(digest));
+    }
+
+    /**
+     * @brief Avanza hasta V::width cadenas a la vez. Con menos tareas, los carriles
+     * sobrantes repiten la última y su resultado se descarta.
+     */
+    template <typename V>
+    static void run(const Task* tasks, size_t count, uint32_t iterations) {
+        typedef typename V::type T;
+        const size_t W = V::width;
+        // Palabra i de todos los carriles, contigua: [palabra][carril].
+        uint32_t inner[8][W], outer[8][W], u[8][W];
+        uint32_t laneInner[8], laneOuter[8], laneU[8];
+
+        for (size_t l = 0; l < W; ++l) {
+            const Task& task = tasks[l < count ? l : count - 1];
+            hmacStates(*task.job, laneInner, laneOuter);
+            firstBlock(*task.job, task.block, laneInner, laneOuter, laneU);
+            for (int i = 0; i < 8; ++i) {
+                inner[i][l] = laneInner[i];
+                outer[i][l] = laneOuter[i];
+                u[i][l] = laneU[i];
+            }
+        }
+
+        T innerV[8], outerV[8], uV[8], acc[8];
+        for (int i = 0; i < 8; ++i) {
+            innerV[i] = V::load(inner[i]);
+            outerV[i] = V::load(outer[i]);
+            uV[i] = V::load(u[i]);
+            acc[i] = uV[i];
+        }
+
+        // Mensaje de un bloque: 32 bytes de resumen + relleno para 64 + 32 bytes.
+        const T padStart = V::set1(0x80000000u);
+        const T zero = V::set1(0);
+        const T bitLength = V::set1((Sha256::kBlockSize + Sha256::kDigestSize) * 8);
+        T w[16];
+        T state[8];
+        for (uint32_t it = 1; it < iterations; ++it) {
+            for (int i = 0; i < 8; ++i) {
+                w[i] = uV[i];
+                state[i] = innerV[i];
+            }
+            w[8] = padStart;
+            for (int i = 9; i < 15; ++i) w[i] = zero;
+            w[15] = bitLength;
+            Sha256::compress<V>(state, w);
+
+            for (int i = 0; i < 8; ++i) {
+                w[i] = state[i];
+                uV[i] = outerV[i];
+            }
+            w[8] = padStart;
+            for (int i = 9; i < 15; ++i) w[i] = zero;
+            w[15] = bitLength;
+            Sha256::compress<V>(uV, w);
+
+            for (int i = 0; i < 8; ++i) acc[i] = V::bxor(acc[i], uV[i]);
+        }
+
+        for (int i = 0; i < 8; ++i) V::store(u[i], acc[i]);
+        for (size_t l = 0; l < count; ++l) {
+            const Job& job = *tasks[l].job;
+            const size_t offset = (tasks[l].block - 1) * Sha256::kDigestSize;
+            uint8_t digest[Sha256::kDigestSize];
+            for (int i = 0; i < 8; ++i) Sha256::storeBigEndian(digest + 4 * i, u[i][l]);
+            const size_t remaining = job.outLength - offset;
+            const size_t take = remaining < Sha256::kDigestSize ? remaining : Sha256::kDigestSize;
+            std::memcpy(job.out + offset, digest, take);
+            SecureArena::wipe(digest, sizeof(digest));
+        }
+
+        SecureArena::wipe(inner, sizeof(inner));
+        SecureArena::wipe(outer, sizeof(outer));
+        SecureArena::wipe(u, sizeof(u));
+        SecureArena::wipe(laneInner, sizeof(laneInner));
+        SecureArena::wipe(laneOuter, sizeof(laneOuter));
+        SecureArena::wipe(laneU, sizeof(laneU));
+        SecureArena::wipe(acc, sizeof(acc));
+        SecureArena::wipe(uV, sizeof(uV));
+        SecureArena::wipe(w, sizeof(w));
+        SecureArena::wipe(state, sizeof(state));
+    }
+};
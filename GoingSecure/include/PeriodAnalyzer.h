@@ -0,0 +1,264 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+
+/**
+ * @class PeriodAnalyzer
+ * @brief Estima el periodo de un cifrado periódico (Vigenère, XOR con clave repetida)
+ * con el índice de coincidencia de todas las longitudes 1..maxPeriod en una sola pasada.
+ *
+ * Para cada L, el texto se reparte en L columnas (posición i -> columna i % L) y el
+ * IC(L) es la media del índice de coincidencia de cada columna. Con la longitud de
+ * clave correcta cada columna es un cifrado de un solo símbolo y conserva el IC del
+ * idioma (~0.077 en español); con una longitud incorrecta el IC cae hacia el de un
+ * texto aleatorio (1/26 ≈ 0.038 en letras).
+ *
+ * No hace falta un histograma por cada L: si L divide a P, la columna k de L es la
+ * unión de las columnas k, k + L, k + 2L... de P. Por eso solo se cuentan unos pocos
+ * periodos "de cobertura" (p. ej. 2520 cubre 1..10, 12, 14, 15...), elegidos para que
+ * todo L <= maxPeriod divida a alguno y sus histogramas quepan en caché; cada símbolo
+ * cuesta un incremento por periodo de cobertura en lugar de uno por cada L, y las
+ * curvas de todos los L se obtienen al final sumando columnas.
+ *
+ * El texto se lee una sola vez, en bloques que se recorren para cada periodo de
+ * cobertura mientras siguen en caché.
+ *
+ * @note Los múltiplos del periodo real tienen un IC parecido (o algo mayor por ruido);
+ * bestPeriod elige el menor periodo cercano al máximo para no confundirlos.
+ */
+class PeriodAnalyzer {
+public:
+    /**
+     * @brief Símbolos que se cuentan.
+     */
+    enum class Alphabet {
+        Letters,    ///< Solo letras ASCII, sin distinguir mayúsculas (Vigenère).
+        Bytes       ///< Todos los bytes (XOR).
+    };
+
+    /**
+     * @brief Resultado del barrido.
+     */
+    struct Result {
+        std::vector<double> ic;             ///< ic[L] para L = 1..maxPeriod (ic[0] sin uso).
+        std::vector<size_t> topPeriods;     ///< Periodos ordenados por IC descendente.
+        size_t bestPeriod = 0;              ///< Menor periodo con IC >= 90% del máximo (0 si no hay datos).
+        uint64_t symbols = 0;               ///< Símbolos contados.
+    };
+
+    /**
+     * @param maxPeriod Mayor longitud de clave a evaluar.
+     * @param alphabet Letras o bytes.
+     * @throws std::invalid_argument Si maxPeriod es 0.
+     */
+    explicit PeriodAnalyzer(size_t maxPeriod = 40, Alphabet alphabet = Alphabet::Letters)
+        : m_maxPeriod(maxPeriod), m_alphabet(alphabet) {
+        if (maxPeriod == 0) {
+            throw std::invalid_argument("El periodo máximo debe ser mayor que 0.");
+        }
+        chooseCoverPeriods();
+    }
+
+    ~PeriodAnalyzer() = default;
+
+    /**
+     * @brief Calcula la curva de IC y los mejores periodos.
+     *
+     * @param data Texto cifrado.
+     * @param length Número de bytes.
+     * @param top Número de periodos a devolver en topPeriods.
+     * @return Result Curva de IC y periodos candidatos.
+     */
+    Result analyze(const uint8_t* data, size_t length, size_t top = 5) const {
+        const size_t A = symbolCount();
+        const size_t covers = m_cover.size();
+
+        // Los histogramas de los periodos de cobertura van seguidos: el periodo
+        // m_cover[p] ocupa m_cover[p] * A contadores a partir de offset[p].
+        std::vector<size_t> offset(covers + 1, 0);
+        for (size_t p = 0; p < covers; ++p) offset[p + 1] = offset[p] + m_cover[p] * A;
+        std::vector<uint64_t> counts(offset[covers], 0);
+        std::vector<size_t> phase(covers, 0);
+
+        std::vector<uint8_t> tile(kTileBytes);
+        uint64_t symbols = 0;
+        for (size_t start = 0; start < length; start += kTileBytes) {
+            const size_t chunk = length - start < kTileBytes ? length - start : kTileBytes;
+            const size_t n = toSymbols(data + start, chunk, tile.data());
+            symbols += n;
+            for (size_t p = 0; p < covers; ++p) {
+                phase[p] = accumulate(tile.data(), n, m_cover[p], phase[p], &counts[offset[p]]);
+            }
+        }
+
+        Result result;
+        result.symbols = symbols;
+        result.ic.assign(m_maxPeriod + 1, 0.0);
+        std::vector<uint64_t> folded;
+        for (size_t L = 1; L <= m_maxPeriod; ++L) {
+            // Columna k de L = suma de las columnas j de P con j % L == k.
+            const size_t p = m_coverOf[L];
+            const size_t P = m_cover[p];
+            folded.assign(L * A, 0);
+            for (size_t j = 0; j < P; ++j) {
+                const uint64_t* source = &counts[offset[p] + j * A];
+                uint64_t* target = &folded[(j % L) * A];
+                for (size_t c = 0; c < A; ++c) target[c] += source[c];
+            }
+            result.ic[L] = averageIc(folded.data(), L);
+        }
+
+        std::vector<size_t> order;
+        for (size_t L = 1; L <= m_maxPeriod; ++L) order.push_back(L);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return result.ic[a] > result.ic[b];
+            });
+        order.resize(std::min(top, order.size()));
+        result.topPeriods = order;
+
+        const double best = *std::max_element(result.ic.begin() + 1, result.ic.end());
+        if (best > 0.0) {
+            for (size_t L = 1; L <= m_maxPeriod; ++L) {
+                if (result.ic[L] >= 0.9 * best) {
+                    result.bestPeriod = L;
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Igual que analyze(data, length, top) sobre un std::string.
+     */
+    Result analyze(const std::string& text, size_t top = 5) const {
+        return analyze(reinterpret_cast<const uint8_t*>(text.data()), text.size(), top);
+    }
+
+    /**
+     * @brief Analiza un archivo proyectándolo en memoria (sin copiarlo).
+     * @throws std::runtime_error Si el archivo no puede abrirse.
+     */
+    Result analyzeFile(const std::string& path, size_t top = 5) const {
+        MappedFile file(path);
+        return analyze(file.data(), file.size(), top);
+    }
+
+    size_t maxPeriod() const { return m_maxPeriod; }
+    Alphabet alphabet() const { return m_alphabet; }
+
+private:
+    static const size_t kTileBytes = 16 * 1024;     ///< Bloque de texto que se reutiliza en caché.
+    static const size_t kCoverCounters = 64 * 1024; ///< Contadores máximos de un periodo de cobertura.
+
+    /**
+     * @brief Elige periodos de cobertura de forma voraz.
+     *
+     * Candidatos: 1..max(maxPeriod, kCoverCounters / A). En cada paso se toma el que
+     * divide a más L aún sin cubrir (en empate, el menor) hasta cubrir 1..maxPeriod.
+     */
+    void chooseCoverPeriods() {
+        const size_t limit = std::max(m_maxPeriod, kCoverCounters / symbolCount());
+        m_coverOf.assign(m_maxPeriod + 1, 0);
+        std::vector<bool> covered(m_maxPeriod + 1, false);
+        size_t remaining = m_maxPeriod;
+
+        while (remaining > 0) {
+            size_t best = 0;
+            size_t bestGain = 0;
+            for (size_t P = 1; P <= limit; ++P) {
+                size_t gain = 0;
+                for (size_t L = 1; L <= m_maxPeriod && L <= P; ++L) {
+                    if (!covered[L] && P % L == 0) gain++;
+                }
+                if (gain > bestGain) {
+                    bestGain = gain;
+                    best = P;
+                }
+            }
+            for (size_t L = 1; L <= m_maxPeriod && L <= best; ++L) {
+                if (!covered[L] && best % L == 0) {
+                    covered[L] = true;
+                    m_coverOf[L] = m_cover.size();
+                    remaining--;
+                }
+            }
+            m_cover.push_back(best);
+        }
+    }
+
+    size_t symbolCount() const {
+        return m_alphabet == Alphabet::Letters ? 26 : 256;
+    }
+
+    /**
+     * @brief Reduce un bloque a símbolos (0..25 para letras, el propio byte para bytes).
+     * @return size_t Símbolos escritos en out.
+     */
+    size_t toSymbols(const uint8_t* in, size_t length, uint8_t* out) const {
+        if (m_alphabet == Alphabet::Bytes) {
+            std::memcpy(out, in, length);
+            return length;
+        }
+        size_t n = 0;
+        for (size_t i = 0; i < length; ++i) {
+            unsigned int folded = (in[i] | 0x20u) - 'a';
+            out[n] = static_cast<uint8_t>(folded);
+            n += folded < 26u ? 1 : 0;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Suma un bloque de símbolos a los histogramas del periodo L.
+     *
+     * @param phase Columna del primer símbolo del bloque.
+     * @return size_t Columna del símbolo siguiente al bloque.
+     */
+    size_t accumulate(const uint8_t* symbols, size_t n, size_t L, size_t phase, uint64_t* hist) const {
+        const size_t A = symbolCount();
+        size_t i = 0;
+        size_t k = phase;
+
+        // Completa la fila en curso, luego filas enteras sin calcular i % L.
+        while (k != 0 && i < n) {
+            hist[k * A + symbols[i++]]++;
+            if (++k == L) k = 0;
+        }
+        for (; i + L <= n; i += L) {
+            for (size_t j = 0; j < L; ++j) hist[j * A + symbols[i + j]]++;
+        }
+        while (i < n) {
+            hist[k * A + symbols[i++]]++;
+            ++k;
+        }
+        return k == L ? 0 : k;
+    }
+
+    /**
+     * @brief Media del IC de las columnas con al menos dos símbolos.
+     */
+    double averageIc(const uint64_t* hist, size_t L) const {
+        const size_t A = symbolCount();
+        double sum = 0.0;
+        size_t columns = 0;
+        for (size_t k = 0; k < L; ++k) {
+            uint64_t total = 0;
+            double pairs = 0.0;
+            for (size_t c = 0; c < A; ++c) {
+                uint64_t n = hist[k * A + c];
+                total += n;
+                pairs += static_cast<double>(n) * static_cast<double>(n == 0 ? 0 : n - 1);
+            }
+            if (total < 2) continue;
+            sum += pairs / (static_cast<double>(total) * static_cast<double>(total - 1));
+            columns++;
+        }
+        return columns == 0 ? 0.0 : sum / columns;
+    }
+
+    size_t m_maxPeriod;             ///< Mayor longitud de clave evaluada.
+    Alphabet m_alphabet;            ///< Símbolos que se cuentan.
+    std::vector<size_t> m_cover;    ///< Periodos que se cuentan realmente.
+    std::vector<size_t> m_coverOf;  ///< m_coverOf[L] = índice en m_cover de un múltiplo de L.
+};
@@ -31,4 +31,14 @@
 #include <stdexcept>
 #include <random>
 #include <mutex>
-#include <array>
\ No newline at end of file
+#include <array>
+#include <limits>
+#include <cmath>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <fstream>
+#include <condition_variable>
+#include <chrono>
+#include <map>
\ No newline at end of file
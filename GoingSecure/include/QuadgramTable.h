@@ -0,0 +1,133 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+
+#include <fstream>
+
+/**
+ * @class QuadgramTable
+ * @brief Tabla de log-probabilidades de cuatrigramas (A..Z) para puntuar texto.
+ *
+ * La tabla es un arreglo plano de 26^4 floats (log10 P) indexado por
+ * ((a * 26 + b) * 26 + c) * 26 + d, sin cabecera: el archivo en disco es
+ * exactamente la tabla, así que cargarla es proyectarla en memoria.
+ *
+ * La tabla del español se genera una vez con buildFromCorpus() sobre un corpus
+ * de texto y se guarda con save() (opción 2 del menú principal, que escribe
+ * DatosOut\cuatrigramas.bin); en tiempo de ejecución basta con load().
+ * Solo cuentan las letras ASCII (como en Vigenere), ignorando el resto.
+ */
+class QuadgramTable {
+public:
+    static const size_t kEntries = 26 * 26 * 26 * 26;  ///< Número de cuatrigramas.
+
+    QuadgramTable() = default;
+    ~QuadgramTable() = default;
+
+    QuadgramTable(const QuadgramTable&) = delete;
+    QuadgramTable& operator=(const QuadgramTable&) = delete;
+
+    /**
+     * @brief Proyecta en memoria una tabla guardada con save().
+     * @param path Ruta del archivo binario (26^4 floats).
+     * @throws std::runtime_error Si el archivo no existe o no tiene el tamaño esperado.
+     */
+    void load(const std::string& path) {
+        MappedFile file(path);
+        if (file.size() != kEntries * sizeof(float)) {
+            throw std::runtime_error("Tabla de cuatrigramas con tamaño inválido: " + path);
+        }
+        m_owned.clear();
+        m_owned.shrink_to_fit();
+        m_map = std::move(file);
+        m_data = reinterpret_cast<const float*>(m_map.data());
+    }
+
+    /**
+     * @brief Construye la tabla contando los cuatrigramas de un corpus.
+     *
+     * Cada entrada es log10(cuenta / total); los cuatrigramas nunca vistos reciben
+     * log10(0.01 / total) para no anular la puntuación de un texto.
+     *
+     * @param corpus Texto de referencia (idealmente varios MB de español).
+     * @throws std::runtime_error Si el corpus no contiene ningún cuatrigrama.
+     */
+    void buildFromCorpus(const std::string& corpus) {
+        std::vector<uint64_t> counts(kEntries, 0);
+        uint64_t total = 0;
+        uint32_t window = 0;
+        unsigned int seen = 0;
+
+        for (char ch : corpus) {
+            unsigned int folded = static_cast<unsigned char>(ch) | 0x20u;
+            if (folded - 'a' >= 26u) continue;
+            window = (window * 26 + (folded - 'a')) % kEntries;
+            if (++seen >= 4) {
+                counts[window]++;
+                total++;
+            }
+        }
+        if (total == 0) {
+            throw std::runtime_error("El corpus no contiene cuatrigramas.");
+        }
+
+        m_map.close();
+        m_owned.resize(kEntries);
+        const double floor = std::log10(0.01 / static_cast<double>(total));
+        for (size_t i = 0; i < kEntries; ++i) {
+            m_owned[i] = counts[i] == 0
+                ? static_cast<float>(floor)
+                : static_cast<float>(std::log10(static_cast<double>(counts[i]) / total));
+        }
+        m_data = m_owned.data();
+    }
+
+    /**
+     * @brief Guarda la tabla actual en formato binario plano.
+     * @param path Ruta de destino.
+     * @throws std::runtime_error Si no hay tabla o no se puede escribir.
+     */
+    void save(const std::string& path) const {
+        if (!loaded()) {
+            throw std::runtime_error("No hay tabla de cuatrigramas que guardar.");
+        }
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(m_data), kEntries * sizeof(float));
+        if (!out) {
+            throw std::runtime_error("No se pudo escribir la tabla en: " + path);
+        }
+    }
+
+    /**
+     * @brief Log-probabilidad del cuatrigrama (a, b, c, d), cada letra en 0..25.
+     */
+    float at(unsigned int a, unsigned int b, unsigned int c, unsigned int d) const {
+        return m_data[((a * 26 + b) * 26 + c) * 26 + d];
+    }
+
+    /**
+     * @brief Acceso directo por índice plano.
+     */
+    float operator[](size_t index) const {
+        return m_data[index];
+    }
+
+    /**
+     * @brief Puntúa una secuencia de letras ya reducidas a 0..25.
+     */
+    double score(const uint8_t* letters, size_t count) const {
+        double total = 0.0;
+        for (size_t i = 0; i + 3 < count; ++i) {
+            total += at(letters[i], letters[i + 1], letters[i + 2], letters[i + 3]);
+        }
+        return total;
+    }
+
+    bool loaded() const { return m_data != nullptr; }
+    const float* data() const { return m_data; }
+
+private:
+    MappedFile m_map;             ///< Proyección del archivo (si se cargó con load()).
+    std::vector<float> m_owned;   ///< Tabla propia (si se construyó desde un corpus).
+    const float* m_data = nullptr;
+};
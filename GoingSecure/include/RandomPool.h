@@ -0,0 +1,73 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "ChaCha20Drbg.h"
+
+/**
+ * @class RandomPool
+ * @brief Generadores ChaCha20 por hilo, sin bloqueos en el camino caliente.
+ *
+ * Cada hilo obtiene su propio ChaCha20Drbg (thread_local) sembrado por separado
+ * con entropía del sistema operativo, así que generar claves, IVs o salts desde
+ * muchos hilos escala con los núcleos en lugar de competir por un mutex.
+ *
+ * Política de resiembra compartida: además de la resiembra periódica de cada
+ * generador, requestReseed() incrementa una época global; cada hilo compara su
+ * época con la global (una lectura atómica) en su siguiente petición y, si ha
+ * cambiado, se resiembra antes de entregar bytes. Útil tras restaurar una
+ * instantánea de máquina virtual o al rotar claves maestras.
+ */
+class RandomPool {
+public:
+    /**
+     * @brief Llena un búfer con bytes aleatorios del generador del hilo actual.
+     * @throws std::runtime_error Si el sistema no entrega entropía al sembrar.
+     */
+    static void fill(uint8_t* out, size_t length) {
+        generator().generate(out, length);
+    }
+
+    /**
+     * @brief Generador del hilo actual, al día con la época de resiembra.
+     *
+     * Sirve como UniformRandomBitGenerator con las distribuciones de <random>.
+     * La referencia solo debe usarse desde el hilo que la obtuvo.
+     */
+    static ChaCha20Drbg& generator() {
+        thread_local Local local;
+        const uint64_t current = epochCounter().load(std::memory_order_relaxed);
+        if (local.epoch != current) {
+            local.drbg.reseed();
+            local.epoch = current;
+        }
+        return local.drbg;
+    }
+
+    /**
+     * @brief Pide a todos los hilos que se resiembren antes de su próxima petición.
+     */
+    static void requestReseed() {
+        epochCounter().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Época de resiembra actual.
+     */
+    static uint64_t epoch() {
+        return epochCounter().load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * @brief Estado por hilo: generador y época con la que se sembró.
+     */
+    struct Local {
+        Local() : epoch(epochCounter().load(std::memory_order_relaxed)) {}
+        ChaCha20Drbg drbg;
+        uint64_t epoch;
+    };
+
+    static std::atomic<uint64_t>& epochCounter() {
+        static std::atomic<uint64_t> counter(0);
+        return counter;
+    }
+};
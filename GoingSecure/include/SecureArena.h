@@ -0,0 +1,396 @@
+﻿#pragma once
+#include "Prerequisites.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class SecureArena
+ * @brief Región de memoria bloqueada en RAM para material de claves.
+ *
+ * La memoria se reserva por trozos con mmap/VirtualAlloc y se bloquea con
+ * mlock/VirtualLock para que nunca vaya al archivo de intercambio (en Linux además
+ * se excluye de los volcados de memoria). Cada trozo se divide en páginas de 4096
+ * bytes y cada página sirve bloques de una sola clase de tamaño (16 a 4096 bytes,
+ * potencias de 2). Una página cuyos bloques están todos libres vuelve a una reserva
+ * común y puede servir a cualquier otra clase; cuando no queda ninguna página
+ * libre se proyecta un trozo nuevo, así que la arena crece en lugar de agotarse.
+ * Crear y destruir claves no llama a malloc salvo al crecer. Al liberar, cada
+ * bloque se borra con wipe(), que el compilador no puede eliminar.
+ *
+ * Las peticiones mayores de 4096 bytes reciben su propia proyección bloqueada,
+ * que se borra y se devuelve al sistema al liberarla.
+ *
+ * @note Si el sistema no permite bloquear la memoria (p. ej. RLIMIT_MEMLOCK bajo)
+ *       la memoria se usa igualmente sin bloquear; locked() lo indica.
+ */
+class SecureArena {
+public:
+    /**
+     * @param chunkSize Bytes de cada trozo bloqueado (se redondea a páginas).
+     * @throws std::bad_alloc Si no se puede reservar el primer trozo.
+     */
+    explicit SecureArena(size_t chunkSize = 256 * 1024) {
+        m_chunkBytes = roundToPages(chunkSize > kSlabBytes ? chunkSize : kSlabBytes);
+        m_chunkBytes = (m_chunkBytes + kSlabBytes - 1) / kSlabBytes * kSlabBytes;
+        for (auto& head : m_partial) head = kNone;
+        addChunk();
+    }
+
+    ~SecureArena() {
+        for (const auto& chunk : m_chunks) {
+            wipe(chunk.second.base, m_chunkBytes);
+            unmapPages(chunk.second.base, m_chunkBytes, chunk.second.locked);
+        }
+        for (const auto& mapping : m_large) {
+            wipe(mapping.first, mapping.second.bytes);
+            unmapPages(mapping.first, mapping.second.bytes, mapping.second.locked);
+        }
+    }
+
+    SecureArena(const SecureArena&) = delete;
+    SecureArena& operator=(const SecureArena&) = delete;
+
+    /**
+     * @brief Arena compartida por SecureAllocator (se crea en el primer uso).
+     *
+     * No se destruye al salir: así sigue válida para objetos estáticos que liberen
+     * claves durante la terminación (cada bloque ya se borra al liberarse).
+     */
+    static SecureArena& global() {
+        static SecureArena* arena = new SecureArena();
+        return *arena;
+    }
+
+    /**
+     * @brief Reserva un bloque de al menos n bytes, alineado a 16.
+     * @throws std::bad_alloc Si n es 0 o el sistema no entrega más memoria.
+     */
+    void* allocate(size_t n) {
+        if (n == 0) throw std::bad_alloc();
+        if (n > kMaxClassBytes) {
+            LargeMapping mapping;
+            mapping.bytes = roundToPages(n);
+            void* block = mapPages(mapping.bytes, mapping.locked);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            try {
+                m_large.emplace(block, mapping);
+            }
+            catch (...) {
+                unmapPages(block, mapping.bytes, mapping.locked);
+                throw;
+            }
+            m_inUse += mapping.bytes;
+            return block;
+        }
+
+        const size_t cls = classOf(n);
+        const size_t bytes = kMinClassBytes << cls;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_partial[cls] == kNone) {
+            if (m_freeSlabs.empty()) addChunk();
+            const size_t index = m_freeSlabs.back();
+            m_freeSlabs.pop_back();
+            Slab& slab = m_slabs[index];
+            slab.cls = cls;
+            slab.used = 0;
+            slab.carved = 0;
+            slab.freeHead = nullptr;
+            pushPartial(index);
+        }
+
+        const size_t index = m_partial[cls];
+        Slab& slab = m_slabs[index];
+        void* block = slab.freeHead;
+        if (block != nullptr) {
+            std::memcpy(&slab.freeHead, block, sizeof(void*));
+            std::memset(block, 0, sizeof(void*));
+        }
+        else {
+            block = slab.base + slab.carved;
+            slab.carved += bytes;
+        }
+        if (++slab.used == kSlabBytes / bytes) removePartial(index);
+        m_inUse += bytes;
+        return block;
+    }
+
+    /**
+     * @brief Borra y libera un bloque obtenido con allocate(n) (mismo n).
+     */
+    void deallocate(void* block, size_t n) {
+        if (block == nullptr) return;
+        if (n > kMaxClassBytes) {
+            LargeMapping mapping;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_large.find(block);
+                if (it == m_large.end()) return;
+                mapping = it->second;
+                m_large.erase(it);
+                m_inUse -= mapping.bytes;
+            }
+            wipe(block, mapping.bytes);
+            unmapPages(block, mapping.bytes, mapping.locked);
+            return;
+        }
+
+        const size_t bytes = kMinClassBytes << classOf(n);
+        wipe(block, bytes);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t index = slabOf(block);
+        Slab& slab = m_slabs[index];
+        const bool wasFull = slab.used == kSlabBytes / bytes;
+        std::memcpy(block, &slab.freeHead, sizeof(void*));
+        slab.freeHead = block;
+        slab.used--;
+        m_inUse -= bytes;
+
+        if (slab.used == 0) {
+            // Página vacía: se borra entera (enlaces incluidos) y queda libre para cualquier clase.
+            if (!wasFull) removePartial(index);
+            wipe(slab.base, kSlabBytes);
+            m_freeSlabs.push_back(index);
+        }
+        else if (wasFull) {
+            pushPartial(index);
+        }
+    }
+
+    /**
+     * @brief Sobrescribe memoria con ceros sin que el compilador pueda omitirlo.
+     *
+     * Usa SecureZeroMemory en Windows; en GCC/Clang, memset seguido de una barrera
+     * que hace visible la memoria a código desconocido.
+     */
+    static void wipe(void* data, size_t length) {
+        if (data == nullptr || length == 0) return;
+#if defined(_WIN32)
+        SecureZeroMemory(data, length);
+#elif defined(__GNUC__) || defined(__clang__)
+        std::memset(data, 0, length);
+        __asm__ __volatile__("" : : "r"(data) : "memory");
+#else
+        volatile uint8_t* p = static_cast<volatile uint8_t*>(data);
+        while (length--) *p++ = 0;
+#endif
+    }
+
+    /**
+     * @brief Bytes de los trozos proyectados (sin contar las peticiones grandes).
+     */
+    size_t capacity() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_chunks.size() * m_chunkBytes;
+    }
+
+    /**
+     * @brief true si todos los trozos proyectados hasta ahora están bloqueados.
+     */
+    bool locked() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_locked;
+    }
+
+    /**
+     * @brief Bytes entregados y aún no liberados (incluido el redondeo de clase).
+     */
+    size_t bytesInUse() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_inUse;
+    }
+
+private:
+    static const size_t kMinClassBytes = 16;
+    static const size_t kMaxClassBytes = 4096;
+    static const size_t kClassCount = 9;    ///< 16, 32, ..., 4096.
+    static const size_t kSlabBytes = kMaxClassBytes;  ///< Página de una sola clase.
+    static const size_t kNone = ~static_cast<size_t>(0);
+
+    /**
+     * @brief Página de kSlabBytes dentro de un trozo.
+     */
+    struct Slab {
+        uint8_t* base = nullptr;
+        size_t cls = 0;
+        size_t used = 0;            ///< Bloques entregados.
+        size_t carved = 0;          ///< Bytes ya repartidos por primera vez.
+        void* freeHead = nullptr;   ///< Bloques liberados (lista enlazada en el propio bloque).
+        size_t prev = kNone;        ///< Vecinos en la lista de páginas con hueco de su clase.
+        size_t next = kNone;
+    };
+
+    struct Chunk {
+        uint8_t* base = nullptr;
+        size_t firstSlab = 0;       ///< Índice en m_slabs de su primera página.
+        bool locked = false;
+    };
+
+    struct LargeMapping {
+        size_t bytes = 0;           ///< Tamaño proyectado (redondeado a páginas).
+        bool locked = false;
+    };
+
+    static size_t classOf(size_t n) {
+        size_t cls = 0;
+        while ((kMinClassBytes << cls) < n) ++cls;
+        return cls;
+    }
+
+    static size_t pageSize() {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwPageSize);
+#else
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    static size_t roundToPages(size_t n) {
+        const size_t page = pageSize();
+        return (n + page - 1) / page * page;
+    }
+
+    /**
+     * @brief Proyecta páginas nuevas (a cero) e intenta bloquearlas.
+     * @throws std::bad_alloc Si el sistema no entrega la memoria.
+     */
+    static void* mapPages(size_t bytes, bool& locked) {
+#if defined(_WIN32)
+        void* pages = VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (pages == nullptr) throw std::bad_alloc();
+        locked = VirtualLock(pages, bytes) != 0;
+#else
+        void* pages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pages == MAP_FAILED) throw std::bad_alloc();
+        locked = mlock(pages, bytes) == 0;
+#if defined(MADV_DONTDUMP)
+        madvise(pages, bytes, MADV_DONTDUMP);
+#endif
+#endif
+        return pages;
+    }
+
+    static void unmapPages(void* pages, size_t bytes, bool locked) {
+#if defined(_WIN32)
+        if (locked) VirtualUnlock(pages, bytes);
+        VirtualFree(pages, 0, MEM_RELEASE);
+#else
+        if (locked) munlock(pages, bytes);
+        munmap(pages, bytes);
+#endif
+    }
+
+    /**
+     * @brief Proyecta un trozo nuevo y deja todas sus páginas libres (con m_mutex tomado).
+     * @throws std::bad_alloc Si el sistema no entrega la memoria.
+     */
+    void addChunk() {
+        Chunk chunk;
+        chunk.base = static_cast<uint8_t*>(mapPages(m_chunkBytes, chunk.locked));
+        chunk.firstSlab = m_slabs.size();
+        const size_t count = m_chunkBytes / kSlabBytes;
+        try {
+            m_slabs.resize(m_slabs.size() + count);
+            m_freeSlabs.reserve(m_freeSlabs.size() + count);
+            m_chunks.emplace(reinterpret_cast<uintptr_t>(chunk.base), chunk);
+        }
+        catch (...) {
+            m_slabs.resize(chunk.firstSlab);
+            unmapPages(chunk.base, m_chunkBytes, chunk.locked);
+            throw;
+        }
+        // Las direcciones bajas se reparten primero.
+        for (size_t i = count; i-- > 0;) {
+            m_slabs[chunk.firstSlab + i].base = chunk.base + i * kSlabBytes;
+            m_freeSlabs.push_back(chunk.firstSlab + i);
+        }
+        m_locked = m_locked && chunk.locked;
+    }
+
+    /**
+     * @brief Página que contiene block (con m_mutex tomado).
+     */
+    size_t slabOf(const void* block) const {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(block);
+        auto it = m_chunks.upper_bound(address);
+        --it;
+        return it->second.firstSlab + (address - it->first) / kSlabBytes;
+    }
+
+    void pushPartial(size_t index) {
+        Slab& slab = m_slabs[index];
+        slab.prev = kNone;
+        slab.next = m_partial[slab.cls];
+        if (slab.next != kNone) m_slabs[slab.next].prev = index;
+        m_partial[slab.cls] = index;
+    }
+
+    void removePartial(size_t index) {
+        Slab& slab = m_slabs[index];
+        if (slab.prev != kNone) m_slabs[slab.prev].next = slab.next;
+        else m_partial[slab.cls] = slab.next;
+        if (slab.next != kNone) m_slabs[slab.next].prev = slab.prev;
+        slab.prev = kNone;
+        slab.next = kNone;
+    }
+
+    size_t m_chunkBytes = 0;
+    bool m_locked = true;
+    size_t m_inUse = 0;
+    std::map<uintptr_t, Chunk> m_chunks;            ///< Trozos por dirección de inicio.
+    std::vector<Slab> m_slabs;
+    std::vector<size_t> m_freeSlabs;                ///< Páginas vacías, para cualquier clase.
+    size_t m_partial[kClassCount];                  ///< Páginas de cada clase con algún bloque libre.
+    std::map<void*, LargeMapping> m_large;          ///< Peticiones grandes y si se bloquearon.
+    mutable std::mutex m_mutex;
+};
+
+/**
+ * @class SecureAllocator
+ * @brief Asignador estándar que toma la memoria de SecureArena::global().
+ *
+ * Con él, std::vector o std::basic_string guardan claves en memoria bloqueada que
+ * se borra al liberarse, también en cada realocación.
+ */
+template <typename T>
+class SecureAllocator {
+public:
+    using value_type = T;
+
+    SecureAllocator() noexcept = default;
+
+    template <typename U>
+    SecureAllocator(const SecureAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max)() / sizeof(T)) throw std::bad_alloc();
+        return static_cast<T*>(SecureArena::global().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        SecureArena::global().deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const SecureAllocator<U>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const SecureAllocator<U>&) const noexcept { return false; }
+};
+
+/**
+ * @brief Bytes de clave en memoria bloqueada que se borran al liberarse.
+ */
+using SecureBytes = std::vector<uint8_t, SecureAllocator<uint8_t>>;
@@ -0,0 +1,249 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "Simd.h"
+
+/**
+ * @class Sha256
+ * @brief SHA-256 (FIPS 180-4) incremental y compresión multi-buffer.
+ *
+ * La función de compresión es una plantilla sobre un tipo de "carriles": con
+ * Lane1 procesa un mensaje; con Lane4 (SSE2) o Lane8 (AVX2) procesa 4 u 8
+ * mensajes independientes a la vez, uno por palabra de 32 bits del registro.
+ * PBKDF2 la usa así para avanzar varias derivaciones en paralelo.
+ */
+class Sha256 {
+public:
+    static const size_t kDigestSize = 32;
+    static const size_t kBlockSize = 64;
+
+    Sha256() {
+        reset();
+    }
+
+    ~Sha256() {
+        wipe();
+    }
+
+    /**
+     * @brief Vuelve al estado inicial (mensaje vacío).
+     */
+    void reset() {
+        static const uint32_t iv[8] = {
+            0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+            0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+        };
+        resume(iv, 0);
+    }
+
+    /**
+     * @brief Continúa desde un estado intermedio tras `processed` bytes (múltiplo de 64).
+     *
+     * Permite precalcular el primer bloque de HMAC (clave ^ ipad/opad) una sola vez.
+     */
+    void resume(const uint32_t state[8], uint64_t processed) {
+        std::memcpy(m_state, state, sizeof(m_state));
+        m_total = processed;
+        m_buffered = 0;
+    }
+
+    void update(const uint8_t* data, size_t length) {
+        m_total += length;
+        if (m_buffered > 0) {
+            const size_t take = std::min(kBlockSize - m_buffered, length);
+            std::memcpy(m_buffer + m_buffered, data, take);
+            m_buffered += take;
+            data += take;
+            length -= take;
+            if (m_buffered < kBlockSize) return;
+            compressBlock(m_state, m_buffer);
+            m_buffered = 0;
+        }
+        for (; length >= kBlockSize; data += kBlockSize, length -= kBlockSize) {
+            compressBlock(m_state, data);
+        }
+        std::memcpy(m_buffer, data, length);
+        m_buffered = length;
+    }
+
+    /**
+     * @brief Añade el relleno y escribe el resumen de 32 bytes.
+     */
+    void finish(uint8_t out[kDigestSize]) {
+        const uint64_t bits = m_total * 8;
+        uint8_t pad[kBlockSize * 2] = { 0x80 };
+        const size_t padLength = (m_buffered < 56 ? 56 : 120) - m_buffered;
+        for (int i = 0; i < 8; ++i) pad[padLength + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+        update(pad, padLength + 8);
+        for (int i = 0; i < 8; ++i) storeBigEndian(out + 4 * i, m_state[i]);
+        wipe();
+    }
+
+    /**
+     * @brief Estado interno actual (8 palabras).
+     */
+    const uint32_t* state() const { return m_state; }
+
+    /**
+     * @brief Resumen de un mensaje completo.
+     */
+    static void hash(const uint8_t* data, size_t length, uint8_t out[kDigestSize]) {
+        Sha256 sha;
+        sha.update(data, length);
+        sha.finish(out);
+    }
+
+    /**
+     * @brief Un bloque de 64 bytes sobre un estado (un solo carril).
+     */
+    static void compressBlock(uint32_t state[8], const uint8_t block[kBlockSize]) {
+        uint32_t w[16];
+        for (int i = 0; i < 16; ++i) w[i] = loadBigEndian(block + 4 * i);
+        compress<Lane1>(state, w);
+    }
+
+    /**
+     * @brief Compresión de un bloque en todos los carriles de V.
+     *
+     * @param state Estado de cada carril (se actualiza).
+     * @param w Las 16 palabras del bloque de cada carril (se usan como espacio de trabajo).
+     */
+    template <typename V>
+    static void compress(typename V::type state[8], typename V::type w[16]) {
+        typedef typename V::type T;
+        static const uint32_t k[64] = {
+            0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+            0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+            0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+            0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+            0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+            0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+            0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+            0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+        };
+
+        T a = state[0], b = state[1], c = state[2], d = state[3];
+        T e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int t = 0; t < 64; ++t) {
+            T wt;
+            if (t < 16) {
+                wt = w[t];
+            }
+            else {
+                const T w15 = w[(t - 15) & 15];
+                const T w2 = w[(t - 2) & 15];
+                const T s0 = V::xor3(V::template rotr<7>(w15), V::template rotr<18>(w15), V::template shr<3>(w15));
+                const T s1 = V::xor3(V::template rotr<17>(w2), V::template rotr<19>(w2), V::template shr<10>(w2));
+                wt = V::add(V::add(w[t & 15], s0), V::add(w[(t - 7) & 15], s1));
+                w[t & 15] = wt;
+            }
+            const T bigS1 = V::xor3(V::template rotr<6>(e), V::template rotr<11>(e), V::template rotr<25>(e));
+            const T ch = V::bxor(V::band(e, f), V::andnot(e, g));
+            const T t1 = V::add(V::add(h, bigS1), V::add(V::add(ch, V::set1(k[t])), wt));
+            const T bigS0 = V::xor3(V::template rotr<2>(a), V::template rotr<13>(a), V::template rotr<22>(a));
+            const T maj = V::bor(V::band(a, b), V::band(c, V::bor(a, b)));
+            const T t2 = V::add(bigS0, maj);
+            h = g;
+            g = f;
+            f = e;
+            e = V::add(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = V::add(t1, t2);
+        }
+
+        state[0] = V::add(state[0], a);
+        state[1] = V::add(state[1], b);
+        state[2] = V::add(state[2], c);
+        state[3] = V::add(state[3], d);
+        state[4] = V::add(state[4], e);
+        state[5] = V::add(state[5], f);
+        state[6] = V::add(state[6], g);
+        state[7] = V::add(state[7], h);
+    }
+
+    static uint32_t loadBigEndian(const uint8_t* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+            (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    static void storeBigEndian(uint8_t* p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+    }
+
+    /**
+     * @brief Un carril: palabras de 32 bits escalares.
+     */
+    struct Lane1 {
+        typedef uint32_t type;
+        static const size_t width = 1;
+        static type load(const uint32_t* p) { return *p; }
+        static void store(uint32_t* p, type v) { *p = v; }
+        static type set1(uint32_t v) { return v; }
+        static type add(type a, type b) { return a + b; }
+        static type band(type a, type b) { return a & b; }
+        static type bor(type a, type b) { return a | b; }
+        static type bxor(type a, type b) { return a ^ b; }
+        static type xor3(type a, type b, type c) { return a ^ b ^ c; }
+        static type andnot(type a, type b) { return ~a & b; }
+        template <int N> static type rotr(type x) { return (x >> N) | (x << (32 - N)); }
+        template <int N> static type shr(type x) { return x >> N; }
+    };
+
+#if defined(GS_HAS_SSE2)
+    /**
+     * @brief Cuatro carriles en un registro SSE2.
+     */
+    struct Lane4 {
+        typedef __m128i type;
+        static const size_t width = 4;
+        static type load(const uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        static void store(uint32_t* p, type v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+        static type set1(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+        static type add(type a, type b) { return _mm_add_epi32(a, b); }
+        static type band(type a, type b) { return _mm_and_si128(a, b); }
+        static type bor(type a, type b) { return _mm_or_si128(a, b); }
+        static type bxor(type a, type b) { return _mm_xor_si128(a, b); }
+        static type xor3(type a, type b, type c) { return _mm_xor_si128(_mm_xor_si128(a, b), c); }
+        static type andnot(type a, type b) { return _mm_andnot_si128(a, b); }
+        template <int N> static type rotr(type x) { return _mm_or_si128(_mm_srli_epi32(x, N), _mm_slli_epi32(x, 32 - N)); }
+        template <int N> static type shr(type x) { return _mm_srli_epi32(x, N); }
+    };
+#endif
+
+#if defined(GS_HAS_AVX2_LANES)
+    /**
+     * @brief Ocho carriles en un registro AVX2 (solo si gsCpuHasAvx2()).
+     */
+    struct Lane8 {
+        typedef __m256i type;
+        static const size_t width = 8;
+        static type load(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static void store(uint32_t* p, type v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+        static type set1(uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+        static type add(type a, type b) { return _mm256_add_epi32(a, b); }
+        static type band(type a, type b) { return _mm256_and_si256(a, b); }
+        static type bor(type a, type b) { return _mm256_or_si256(a, b); }
+        static type bxor(type a, type b) { return _mm256_xor_si256(a, b); }
+        static type xor3(type a, type b, type c) { return _mm256_xor_si256(_mm256_xor_si256(a, b), c); }
+        static type andnot(type a, type b) { return _mm256_andnot_si256(a, b); }
+        template <int N> static type rotr(type x) { return _mm256_or_si256(_mm256_srli_epi32(x, N), _mm256_slli_epi32(x, 32 - N)); }
+        template <int N> static type shr(type x) { return _mm256_srli_epi32(x, N); }
+    };
+#endif
+
+private:
+    void wipe() {
+        volatile uint8_t* p = m_buffer;
+        for (size_t i = 0; i < sizeof(m_buffer); ++i) p[i] = 0;
+    }
+
+    uint32_t m_state[8];
+    uint8_t m_buffer[kBlockSize];
+    size_t m_buffered = 0;
+    uint64_t m_total = 0;
+};
@@ -0,0 +1,159 @@
+﻿#pragma once
+#include <cstdint>
+
+/**
+ * @file Simd.h
+ * @brief Extensiones SIMD disponibles y selección de kernels en tiempo de ejecución.
+ *
+ * El proyecto se compila para la base x64 (SSE2). Los kernels SSSE3 y AVX2 se
+ * compilan aparte, sin exigir /arch: en MSVC los intrínsecos no lo necesitan y en
+ * GCC/Clang cada kernel lleva GS_TARGET_SSSE3 / GS_TARGET_AVX2. Quien los llama
+ * comprueba antes gsCpuHasSsse3() / gsCpuHasAvx2() (CPUID, consultado una vez) y
+ * conserva siempre la ruta escalar equivalente, así que el mismo binario funciona
+ * en cualquier CPU x64.
+ *
+ * - GS_HAS_SSE2  : SSE2 (siempre presente en x64).
+ * - GS_HAS_SSSE3 : hay kernels SSSE3 (pshufb) compilados.
+ * - GS_HAS_AVX2  : hay kernels AVX2 (registros de 256 bits) compilados.
+ * - GS_HAS_AVX2_LANES : código genérico instanciable con __m256i (Sha256::Lane8).
+ *
+ * Los kernels reciben punteros y no vectores de 256 bits: en GCC/Clang una función
+ * sin AVX y otra con GS_TARGET_AVX2 no se pasan __m256i por valor con la misma ABI.
+ * Por eso el código genérico que sí lo hace (GS_HAS_AVX2_LANES) solo se compila en
+ * MSVC o con -mavx2; en ambos casos se usa tras comprobar gsCpuHasAvx2().
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GS_HAS_SSE2 1
+#endif
+
+#if defined(GS_HAS_SSE2)
+#define GS_HAS_SSSE3 1
+#define GS_HAS_AVX2 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define GS_TARGET_SSSE3
+#define GS_TARGET_AVX2
+#else
+#define GS_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define GS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(GS_HAS_AVX2) && ((defined(_MSC_VER) && !defined(__clang__)) || defined(__AVX2__))
+#define GS_HAS_AVX2_LANES 1
+#endif
+
+#if defined(GS_HAS_SSE2)
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief true si la CPU ejecuta SSSE3.
+ */
+inline bool gsCpuHasSsse3() {
+#if defined(__SSSE3__) || defined(__AVX__)
+    return true;
+#elif defined(GS_HAS_SSSE3) && defined(_MSC_VER) && !defined(__clang__)
+    static const bool supported = [] {
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+    }();
+    return supported;
+#elif defined(GS_HAS_SSSE3)
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3") != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief true si la CPU ejecuta AVX2 y el sistema guarda los registros YMM.
+ */
+inline bool gsCpuHasAvx2() {
+#if defined(__AVX2__)
+    return true;
+#elif defined(GS_HAS_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+    static const bool supported = [] {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        // OSXSAVE y AVX; XCR0 debe tener activos los estados SSE y AVX.
+        const int osxsaveAvx = (1 << 27) | (1 << 28);
+        if ((info[2] & osxsaveAvx) != osxsaveAvx) return false;
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return supported;
+#elif defined(GS_HAS_AVX2)
+    // libgcc ya comprueba el soporte del sistema (XGETBV) para AVX2.
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Cuenta los bits a 1 de un entero de 32 bits.
+ *
+ * Usa la instrucción POPCNT cuando el compilador la garantiza (/arch:AVX2 la implica)
+ * y un conteo SWAR en otro caso.
+ */
+inline int gsPopcount32(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(value);
+#elif defined(_MSC_VER) && defined(__AVX2__)
+    return static_cast<int>(__popcnt(value));
+#else
+    value = value - ((value >> 1) & 0x55555555u);
+    value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+    return static_cast<int>((((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#endif
+}
+
+/**
+ * @brief Cuenta los bits a 1 de un entero de 64 bits.
+ */
+inline int gsPopcount64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX2__)
+    return static_cast<int>(__popcnt64(value));
+#else
+    return gsPopcount32(static_cast<uint32_t>(value)) + gsPopcount32(static_cast<uint32_t>(value >> 32));
+#endif
+}
+
+/**
+ * @brief Índice del bit a 1 menos significativo (value no debe ser 0).
+ */
+inline int gsCountTrailingZeros64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    int index = 0;
+    while ((value & 1u) == 0) {
+        value >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
@@ -1,5 +1,9 @@
 #pragma once	
 #include "Prerequisites.h"
+#include "AhoCorasick.h"
+#include "Simd.h"
+#include "CandidateFilter.h"
+#include "ColumnLayout.h"
 
 class
 	Vigenere {
@@ -7,9 +11,10 @@ public:
 	Vigenere() = default;
 
 	Vigenere(const std::string& key) :key(normalizeKey(key)) {
-		if (key.empty()) {
+		if (this->key.empty()) {
 			throw std::invalid_argument("La clave no puede estar vaca o sin letras.");
 		}
+		prepareShifts();
 	}
 
 	static std::string
@@ -24,56 +29,244 @@ public:
 	}
 
 	std::string encode(const std::string& text) {
-		std::string result;
-		result.reserve(text.size()); // Reserve space for efficiency
-		unsigned int i = 0; // Index for the key
+		std::string result(text.size(), '\0');
+		applyShifts(text.data(), text.size(), &result[0], encodeShifts.data(), keyWrap.data(), 0);
+		return result; // Return the encoded string
+	}
 
-		for (char c : text) {
-			if (std::isalpha(static_cast<unsigned char>(c))) {
-				bool isLower = std::islower(static_cast<unsigned char>(c));
-				char base = isLower ? 'a' : 'A'; // Determine base based on case
+	std::string decode(const std::string& text) {
+		std::string result(text.size(), '\0');
+		applyShifts(text.data(), text.size(), &result[0], decodeShifts.data(), keyWrap.data(), 0);
+		return result; // Return the decoded string
+	}
 
-				// Desplazamiento de la key
-				int shift = key[i % key.size()] - 'A'; // Calculate shift based on key character mod26
-				// Encode
-				char encodedChar = static_cast<char>((c - base + shift) % 26 + base);
-				result += encodedChar; // Append encoded character to result
-				i++; // Increment key index
-			}
-			else {
-				result += c; // Non-alphabetic characters are added unchanged
-			}
-		}
+	static double fitness(const std::string& text) {
+		return fitness(text.data(), text.size());
+	}
 
-		return result; // Return the encoded string
+	/**
+	 * @brief Punta un texto por las palabras comunes del espaol que contiene.
+	 *
+	 * La lista se compila una sola vez en un autmata de Aho-Corasick, as que el
+	 * texto se recorre en una nica pasada en lugar de una bsqueda por palabra.
+	 */
+	static double fitness(const char* text, size_t length) {
+		static const AhoCorasick comunes(commonWords());
+		return comunes.score(text, length);
 	}
 
-	std::string decode(const std::string& text) {
-		std::string result;
-		result.reserve(text.size()); // Reserve space for efficiency
-		unsigned int i = 0; // Index for the key
+	/**
+	 * @brief Contadores de una bsqueda de claves (para comparar estrategias).
+	 */
+	struct SearchStats {
+		uint64_t nodesVisited = 0; ///< Nodos del rbol de claves visitados (incluye hojas).
+		uint64_t nodesPruned = 0;  ///< Subrboles descartados sin explorarlos.
+		uint64_t fullScores = 0;   ///< Candidatos puntuados sobre el texto completo.
+	};
+
+	/**
+	 * @brief Fuerza bruta exhaustiva: prueba todas las claves hasta maxKeyLenght letras.
+	 *
+	 * Envoltorio de VigenereBreaker (estrategia exhaustiva) que imprime el resultado.
+	 *
+	 * @param stats Si no es nulo, acumula los nodos visitados y las puntuaciones completas.
+	 * @param filter Si no es nulo, filtro de dos etapas (muestra corta antes del texto completo).
+	 * @return std::string Clave con mayor fitness().
+	 */
+	static std::string breakEncode(const std::string& text, int maxKeyLenght,
+		SearchStats* stats = nullptr, const CandidateFilter* filter = nullptr);
+
+	/**
+	 * @brief Rompe Vigenre con ramificacin y poda sobre la verosimilitud por columna.
+	 *
+	 * Envoltorio de VigenereBreaker (estrategia de ramificacin y poda) que imprime
+	 * el resultado y, si se pide, los nodos visitados y podados.
+	 *
+	 * @param stats Si no es nulo, acumula nodos visitados y podados.
+	 * @return std::string Clave encontrada.
+	 */
+	static std::string breakEncodeBranchAndBound(const std::string& text, int maxKeyLenght,
+		SearchStats* stats = nullptr);
 
-		for (char c : text) {
-			if (std::isalpha(static_cast<unsigned char>(c))) {
-				bool isLower = std::islower(static_cast<unsigned char>(c));
-				char base = isLower ? 'a' : 'A'; // Determine base based on case
+private:
+	/**
+	 * @brief Precalcula la clave como vector de desplazamientos para encode/decode.
+	 *
+	 * encodeShifts/decodeShifts repiten la clave hasta cubrir L + 32 posiciones, as
+	 * que desde cualquier fase se pueden leer 32 desplazamientos consecutivos sin
+	 * dar la vuelta. keyWrap[v] = v % L para v < L + 33 sustituye a la divisin al
+	 * avanzar la fase de la clave.
+	 */
+	void prepareShifts() {
+		const size_t L = key.size();
+		encodeShifts.resize(L + 32);
+		decodeShifts.resize(L + 32);
+		for (size_t i = 0; i < L + 32; ++i) {
+			uint8_t shift = static_cast<uint8_t>(key[i % L] - 'A');
+			encodeShifts[i] = shift;
+			decodeShifts[i] = static_cast<uint8_t>((26 - shift) % 26);
+		}
+		keyWrap.resize(L + 33);
+		for (size_t v = 0; v < keyWrap.size(); ++v) {
+			keyWrap[v] = static_cast<uint32_t>(v % L);
+		}
+	}
 
-				// Desplazamiento de la key
-				int shift = key[i % key.size()] - 'A'; // Calculate shift based on key character mod26
-				// decode
-				char encodedChar = static_cast<char>(((c - base) - shift + 26) % 26 + base);
-				result += encodedChar; // Append encoded character to result
-				i++; // Increment key index
+	/**
+	 * @brief Aplica la clave desplazando solo las letras ASCII y devuelve la nueva fase.
+	 *
+	 * Cada letra suma (mod 26, conservando mayscula/minscula) el desplazamiento de
+	 * la posicin actual de la clave; el resto de bytes se copia tal cual y no avanza
+	 * la clave. Es la misma semntica que std::isalpha en el locale "C".
+	 *
+	 * Ruta vectorizada: por bloque se calcula la mscara de letras, su suma prefija
+	 * exclusiva (cuntas letras hay antes de cada byte en el bloque) y con pshufb se
+	 * reparte a cada letra su desplazamiento ledo de shifts + fase. Sumar y restar
+	 * 26 con min_epu8 resuelve el mdulo sin ramas.
+	 *
+	 * @param in Texto de entrada.
+	 * @param length Nmero de bytes.
+	 * @param out Destino (puede ser el mismo que in).
+	 * @param shifts Desplazamientos repetidos (L + 32 entradas).
+	 * @param wrap Tabla v -> v % L (L + 33 entradas).
+	 * @param phase Posicin de la clave para el primer byte.
+	 * @return size_t Posicin de la clave tras el ltimo byte.
+	 */
+	size_t applyShifts(const char* in, size_t length, char* out,
+		const uint8_t* shifts, const uint32_t* wrap, size_t phase) const {
+		const size_t L = key.size();
+		size_t i = 0;
+
+#if defined(GS_HAS_AVX2)
+		if (gsCpuHasAvx2()) {
+			i = applyShiftsAvx2(in, length, out, shifts, wrap, phase);
+		}
+#endif
+#if defined(GS_HAS_SSSE3)
+		if (gsCpuHasSsse3()) {
+			i += applyShiftsSsse3(in + i, length - i, out + i, shifts, wrap, phase);
+		}
+#else
+		(void)wrap; // Solo la ruta vectorizada avanza la fase por bloques.
+#endif
+
+		// Cola escalar (y ruta completa sin SIMD): mismo clculo, sin isalpha ni mdulo.
+		for (; i < length; ++i) {
+			unsigned char c = static_cast<unsigned char>(in[i]);
+			unsigned int folded = c | 0x20u;
+			if (folded - 'a' < 26u) {
+				unsigned int value = folded - 'a' + shifts[phase];
+				if (value >= 26) value -= 26;
+				out[i] = static_cast<char>((value + 'A') | (c & 0x20u));
+				if (++phase == L) phase = 0;
 			}
 			else {
-				result += c; // Non-alphabetic characters are added unchanged
+				out[i] = static_cast<char>(c);
 			}
 		}
+		return phase;
+	}
 
-		return result; // Return the encoded string
+#if defined(GS_HAS_AVX2)
+	/**
+	 * @brief Bloques de 32 bytes de applyShifts() (una ventana de 16 desplazamientos por carril).
+	 * @return size_t Bytes procesados (mltiplo de 32); phase queda en la posicin siguiente.
+	 */
+	GS_TARGET_AVX2 static size_t applyShiftsAvx2(const char* in, size_t length, char* out,
+		const uint8_t* shifts, const uint32_t* wrap, size_t& phase) {
+		const __m256i one = _mm256_set1_epi8(1);
+		const __m256i caseBit = _mm256_set1_epi8(0x20);
+		const __m256i beforeA = _mm256_set1_epi8('a' - 1);
+		const __m256i afterZ = _mm256_set1_epi8('z' + 1);
+		const __m256i lowerA = _mm256_set1_epi8('a');
+		const __m256i upperA = _mm256_set1_epi8('A');
+		const __m256i twentySix = _mm256_set1_epi8(26);
+		size_t i = 0;
+		for (; i + 32 <= length; i += 32) {
+			__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+			__m256i folded = _mm256_or_si256(c, caseBit);
+			__m256i isAlpha = _mm256_and_si256(_mm256_cmpgt_epi8(folded, beforeA),
+				_mm256_cmpgt_epi8(afterZ, folded));
+
+			// Suma prefija por carril de 128 bits: letras antes de cada byte.
+			__m256i bits = _mm256_and_si256(isAlpha, one);
+			__m256i prefix = _mm256_add_epi8(bits, _mm256_slli_si256(bits, 1));
+			prefix = _mm256_add_epi8(prefix, _mm256_slli_si256(prefix, 2));
+			prefix = _mm256_add_epi8(prefix, _mm256_slli_si256(prefix, 4));
+			prefix = _mm256_add_epi8(prefix, _mm256_slli_si256(prefix, 8));
+			prefix = _mm256_sub_epi8(prefix, bits);
+
+			uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(isAlpha));
+			int lowCount = gsPopcount32(mask & 0xFFFFu);
+			int highCount = gsPopcount32(mask >> 16);
+
+			__m256i window = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(shifts + phase))),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(shifts + phase + lowCount)), 1);
+			__m256i shift = _mm256_shuffle_epi8(window, prefix);
+
+			__m256i value = _mm256_add_epi8(_mm256_sub_epi8(folded, lowerA), shift);
+			value = _mm256_min_epu8(value, _mm256_sub_epi8(value, twentySix));
+			__m256i shifted = _mm256_or_si256(_mm256_add_epi8(value, upperA),
+				_mm256_and_si256(c, caseBit));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+				_mm256_blendv_epi8(c, shifted, isAlpha));
+			phase = wrap[phase + lowCount + highCount];
+		}
+		return i;
+	}
+#endif
+
+#if defined(GS_HAS_SSSE3)
+	/**
+	 * @brief Bloques de 16 bytes de applyShifts().
+	 * @return size_t Bytes procesados (mltiplo de 16); phase queda en la posicin siguiente.
+	 */
+	GS_TARGET_SSSE3 static size_t applyShiftsSsse3(const char* in, size_t length, char* out,
+		const uint8_t* shifts, const uint32_t* wrap, size_t& phase) {
+		const __m128i one = _mm_set1_epi8(1);
+		const __m128i caseBit = _mm_set1_epi8(0x20);
+		const __m128i beforeA = _mm_set1_epi8('a' - 1);
+		const __m128i afterZ = _mm_set1_epi8('z' + 1);
+		const __m128i lowerA = _mm_set1_epi8('a');
+		const __m128i upperA = _mm_set1_epi8('A');
+		const __m128i twentySix = _mm_set1_epi8(26);
+		size_t i = 0;
+		for (; i + 16 <= length; i += 16) {
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+			__m128i folded = _mm_or_si128(c, caseBit);
+			__m128i isAlpha = _mm_and_si128(_mm_cmpgt_epi8(folded, beforeA),
+				_mm_cmpgt_epi8(afterZ, folded));
+
+			__m128i bits = _mm_and_si128(isAlpha, one);
+			__m128i prefix = _mm_add_epi8(bits, _mm_slli_si128(bits, 1));
+			prefix = _mm_add_epi8(prefix, _mm_slli_si128(prefix, 2));
+			prefix = _mm_add_epi8(prefix, _mm_slli_si128(prefix, 4));
+			prefix = _mm_add_epi8(prefix, _mm_slli_si128(prefix, 8));
+			prefix = _mm_sub_epi8(prefix, bits);
+
+			int count = gsPopcount32(static_cast<uint32_t>(_mm_movemask_epi8(isAlpha)));
+			__m128i shift = _mm_shuffle_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(shifts + phase)), prefix);
+
+			__m128i value = _mm_add_epi8(_mm_sub_epi8(folded, lowerA), shift);
+			value = _mm_min_epu8(value, _mm_sub_epi8(value, twentySix));
+			__m128i shifted = _mm_or_si128(_mm_add_epi8(value, upperA),
+				_mm_and_si128(c, caseBit));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+				_mm_or_si128(_mm_and_si128(isAlpha, shifted), _mm_andnot_si128(isAlpha, c)));
+			phase = wrap[phase + count];
+		}
+		return i;
 	}
+#endif
 
-	static double fitness(const std::string& text) {
+	/**
+	 * @brief Palabras comunes del espaol que busca fitness(), con un espacio a cada lado.
+	 */
+	static const std::vector<std::string>& commonWords() {
 		static const std::vector<std::string> comunes = {
 		" DE ", " LA ", " EL ", " QUE ", " Y ",
 		" A ", " EN ", " UN ", " PARA ", " CON ",
@@ -87,128 +280,693 @@ public:
 		" UNO ", " OTRO ", " NUEVO ", " SIN ", " ENTRE ",
 		" SOBRE "
 		};
+		return comunes;
+	}
+
+	std::string key; // The key for the Vigenere cipher
+	std::vector<uint8_t> encodeShifts;  ///< Desplazamientos de cifrado (clave repetida).
+	std::vector<uint8_t> decodeShifts;  ///< Desplazamientos de descifrado (26 - clave).
+	std::vector<uint32_t> keyWrap;      ///< v -> v % L, para avanzar la fase sin dividir.
+
+	friend class VigenereStream;
+	friend class VigenereBreaker;
+};
+
 
-		double score = 0;
-		for (auto& w : comunes) {
-			size_t pos = 0;
-			while ((pos = text.find(w, pos)) != std::string::npos) {
-				score += w.length();
-				pos += w.length();
+/**
+ * @class VigenereStream
+ * @brief Cifra o descifra Vigenre por bloques conservando la fase de la clave.
+ *
+ * Vigenere::encode/decode empiezan siempre por la primera letra de la clave, as que
+ * procesar un archivo en trozos con ellas rompe el flujo de clave. Este contexto
+ * recuerda en qu letra de la clave va (solo avanzan las letras del texto), de modo
+ * que concatenar las salidas de varios process() da lo mismo que una sola llamada
+ * sobre el texto completo. Con la versin de flujos, un archivo de cualquier tamao
+ * se procesa en memoria constante.
+ */
+class VigenereStream {
+public:
+	/**
+	 * @brief Sentido de la transformacin.
+	 */
+	enum class Mode {
+		Encode,
+		Decode
+	};
+
+	/**
+	 * @param key Clave (se normaliza como en Vigenere).
+	 * @param mode Cifrar o descifrar.
+	 * @throws std::invalid_argument Si la clave no contiene letras.
+	 */
+	VigenereStream(const std::string& key, Mode mode)
+		: cipher(key), mode(mode) {}
+
+	/**
+	 * @brief Procesa un bloque de bytes y avanza la fase de la clave.
+	 *
+	 * @param in Bytes de entrada.
+	 * @param length Nmero de bytes.
+	 * @param out Destino de length bytes (puede ser el mismo que in).
+	 * @throws std::logic_error Si el cifrador no tiene clave (objeto movido).
+	 */
+	void process(const char* in, size_t length, char* out) {
+		if (cipher.keyWrap.empty()) {
+			throw std::logic_error("VigenereStream sin clave.");
+		}
+		if (length == 0) return;
+		const std::vector<uint8_t>& shifts =
+			mode == Mode::Encode ? cipher.encodeShifts : cipher.decodeShifts;
+		keyPhase = cipher.applyShifts(in, length, out, shifts.data(), cipher.keyWrap.data(), keyPhase);
+	}
+
+	/**
+	 * @brief Procesa un bloque de texto y devuelve el resultado.
+	 */
+	std::string process(const std::string& chunk) {
+		std::string result(chunk.size(), '\0');
+		if (!chunk.empty()) process(chunk.data(), chunk.size(), &result[0]);
+		return result;
+	}
+
+	/**
+	 * @brief Procesa todo un flujo de entrada hacia uno de salida por bloques.
+	 *
+	 * @param in Flujo de entrada (abrir en modo binario).
+	 * @param out Flujo de salida (abrir en modo binario).
+	 * @param chunkSize Tamao del bfer intermedio en bytes.
+	 * @return uint64_t Bytes procesados.
+	 * @throws std::runtime_error Si falla la escritura.
+	 */
+	uint64_t process(std::istream& in, std::ostream& out, size_t chunkSize = 1 << 16) {
+		std::vector<char> buffer(std::max<size_t>(chunkSize, 1));
+		uint64_t total = 0;
+		while (in) {
+			in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			const size_t got = static_cast<size_t>(in.gcount());
+			if (got == 0) break;
+			process(buffer.data(), got, buffer.data());
+			if (!out.write(buffer.data(), static_cast<std::streamsize>(got))) {
+				throw std::runtime_error("Error al escribir el flujo de salida.");
 			}
+			total += got;
 		}
-		return score;
+		return total;
+	}
+
+	/**
+	 * @brief Vuelve a empezar por la primera letra de la clave.
+	 */
+	void reset() { keyPhase = 0; }
 
+	/**
+	 * @brief Letra de la clave que se aplicar a la prxima letra del texto.
+	 */
+	size_t phase() const { return keyPhase; }
+
+private:
+	Vigenere cipher;       ///< Clave normalizada y tablas de desplazamiento.
+	Mode mode;             ///< Cifrar o descifrar.
+	size_t keyPhase = 0;   ///< Posicin actual en la clave.
+};
+
+
+/**
+ * @class VigenereBreaker
+ * @brief Rompe Vigenre sin estado global, con cancelacin y reporte de progreso.
+ *
+ * El objeto solo guarda la configuracin (longitud mxima, estrategia, callback y
+ * token); todo el estado de la bsqueda vive dentro de run(), as que varias
+ * llamadas pueden ejecutarse a la vez desde distintos hilos, con uno o varios
+ * objetos. La configuracin no debe modificarse mientras haya bsquedas en curso.
+ *
+ * Estrategias:
+ * - Exhaustive: prueba todas las claves y punta con Vigenere::fitness(). Cada nivel
+ *   del DFS punta de una vez, para sus 26 letras, las palabras que su columna termina
+ *   de decidir; una hoja suma L valores. Esa suma es una cota superior de fitness() y
+ *   solo las hojas cuya cota supera a la mejor clave se descifran y puntan completas.
+ *   Cada nodo suma adems el mximo que podran aportar las palabras an sin decidir;
+ *   si ni as supera a la mejor clave, el subrbol se poda sin visitarlo.
+ * - BranchAndBound: punta cada columna con la log-verosimilitud de sus letras frente
+ *   a las frecuencias del espaol; la cota de una clave parcial es lo decidido ms el
+ *   mejor valor de cada columna restante, y se podan las ramas que no pueden superar
+ *   a la mejor clave. Entre longitudes se elige la de mayor fitness() (en empate, la
+ *   ms corta).
+ */
+class VigenereBreaker {
+public:
+	enum class Strategy {
+		Exhaustive,
+		BranchAndBound
+	};
+
+	/**
+	 * @brief Bandera de cancelacin compartida entre quien lanza y quien ejecuta la bsqueda.
+	 *
+	 * Las copias comparten la misma bandera: el planificador conserva una copia y
+	 * llama a cancel(); la bsqueda la consulta en cada nodo y termina en cuanto la ve.
+	 */
+	class CancellationToken {
+	public:
+		CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+		void cancel() const { flag->store(true, std::memory_order_relaxed); }
+		bool isCancelled() const { return flag->load(std::memory_order_relaxed); }
+
+	private:
+		std::shared_ptr<std::atomic<bool>> flag;
+	};
+
+	/**
+	 * @brief Recibe la fraccin completada (0..1). Se invoca desde el hilo de run().
+	 */
+	using ProgressCallback = std::function<void(double)>;
+
+	/**
+	 * @brief Resultado de una bsqueda.
+	 */
+	struct Result {
+		std::string key;        ///< Mejor clave encontrada (vaca si se cancel antes de la primera hoja).
+		std::string text;       ///< Texto descifrado con esa clave.
+		double score = -std::numeric_limits<double>::infinity();  ///< fitness() del texto.
+		Vigenere::SearchStats stats;  ///< Nodos visitados y podados.
+		bool cancelled = false; ///< true si la bsqueda se interrumpi (resultado parcial).
+	};
+
+	explicit VigenereBreaker(int maxKeyLength = 3, Strategy strategy = Strategy::Exhaustive)
+		: maxKeyLength(maxKeyLength), strategy(strategy) {}
+
+	void setProgressCallback(ProgressCallback callback) { progress = std::move(callback); }
+	void setCancellationToken(const CancellationToken& token) { cancellation = token; }
+
+	/**
+	 * @brief Filtro de dos etapas para la estrategia exhaustiva (desactivado por defecto).
+	 *
+	 * Cada hoja punta primero las palabras de la muestra inicial del texto; solo las
+	 * que quedan cerca de la mejor muestra puntan las palabras del resto del texto.
+	 * Cada run() trabaja con su propia copia del filtro.
+	 */
+	void setCandidateFilter(const CandidateFilter& candidateFilter) { filter = candidateFilter; }
+
+	/**
+	 * @brief Ejecuta la bsqueda sobre un texto cifrado.
+	 * @param text Texto cifrado.
+	 * @return Result Mejor clave, texto, estadsticas y si hubo cancelacin.
+	 */
+	Result run(const std::string& text) const {
+		Search search(*this, text);
+		for (int L = 1; L <= maxKeyLength && !search.stopped(); ++L) {
+			if (strategy == Strategy::Exhaustive) {
+				search.exhaustive(L);
+			}
+			else {
+				search.branchAndBound(L);
+			}
+		}
+		search.result.cancelled = search.stopped();
+		if (!search.result.cancelled) search.report(1.0);
+		return search.result;
 	}
 
-	static std::string breakEncode(const std::string& text, int maxKeyLenght) {
-		std::string bestKey;
-		std::string bestText;
+private:
+	/**
+	 * @brief Estado de una bsqueda concreta (local a run()).
+	 */
+	struct Search {
+		Search(const VigenereBreaker& owner, const std::string& text)
+			: owner(owner), text(text), decodedText(text), filter(owner.filter) {
+			// Solo las letras avanzan el ndice de la clave: la letra j pertenece a la columna j % L.
+			for (size_t i = 0; i < text.size(); ++i) {
+				if (std::isalpha(static_cast<unsigned char>(text[i]))) {
+					letters.push_back(i);
+					letterText += text[i];
+				}
+			}
+			for (int L = 1; L <= owner.maxKeyLength; ++L) totalLeaves += std::pow(26.0, L);
+
+			filter.reset();
+			sampleLength = filter.sampleLength(text.size());
+			findWords();
+			for (const std::string& word : Vigenere::commonWords()) {
+				const size_t length = word.size() - 2;
+				if (dictionary.size() <= length) dictionary.resize(length + 1);
+				dictionary[length].push_back(word.substr(1, length));
+			}
+			wordLetters.resize(dictionary.size());
+			variable.resize(dictionary.size());
+		}
+
+		const VigenereBreaker& owner;
+		const std::string& text;
+		std::vector<size_t> letters;
+		std::string letterText;         ///< Solo las letras del texto, en orden.
+		ColumnLayout columns;           ///< letterText por columnas (bfer reutilizado entre L).
+		std::string decodedText;        ///< Texto descifrado de la hoja que se punta completa.
 		std::string trailKey;
+		std::vector<char> variants;
+		std::vector<size_t> columnStart;
+		std::vector<size_t> columnCount;    ///< Letras de cada columna.
+		CandidateFilter filter;
+		size_t sampleLength = 0;            ///< Bytes puntuados en la primera etapa.
+		std::vector<double> subtreeLeaves;  ///< subtreeLeaves[pos] = 26^(L - pos - 1).
+		double totalLeaves = 0.0;
+		double doneLeaves = 0.0;
+		Result result;
+
+		bool stopped() const { return owner.cancellation.isCancelled(); }
+
+		void report(double fraction) const {
+			if (owner.progress) owner.progress(fraction);
+		}
+
+		void prepareLevel(int L) {
+			trailKey.assign(L, 'A');
+			subtreeLeaves.assign(L + 1, 1.0);
+			for (int pos = L - 1; pos >= 0; --pos) subtreeLeaves[pos] = subtreeLeaves[pos + 1] * 26.0;
+		}
+
+		void consider(const std::string& key, const std::string& decoded, double score) {
+			if (score > result.score) {
+				result.score = score;
+				result.key = key;
+				result.text = decoded;
+			}
+		}
 
-		double bestScore = -std::numeric_limits<double>::infinity(); // Initialize best score
+		/**
+		 * @brief Palabra que puede coincidir con commonWords(): letras maysculas entre dos espacios.
+		 */
+		struct Word {
+			size_t letter = 0;  ///< ndice en letters de su primera letra.
+			size_t length = 0;  ///< Nmero de letras.
+		};
+
+		/**
+		 * @brief Palabras agrupadas por la ltima columna (en orden del DFS) que contienen.
+		 */
+		struct WordLevels {
+			std::vector<Word> all;      ///< Palabras en orden del texto.
+			std::vector<Word> byLevel;  ///< all agrupadas por columna.
+			std::vector<size_t> start;  ///< Palabras de la columna k: [start[k], start[k + 1]).
+			std::vector<double> best;   ///< best[k]: lo mximo que pueden sumar las palabras de la columna k.
+		};
 
-		// Funcion revursiva para generar todas las posibles claves de longitud
-		std::function<void(int, int)> dfs = [&](int pos, int maxLen) {
-			if (pos == maxLen) {
-				Vigenere v(trailKey);
-				std::string decodedText = v.decode(text);
-				double score = fitness(decodedText); // Score the decoded text
-				if (score > bestScore) {
-					bestScore = score;
-					bestKey = trailKey;
-					bestText = decodedText;
+		using Gains = std::array<double, 26>;
+
+		std::vector<std::vector<std::string>> dictionary;  ///< commonWords() sin espacios, por longitud.
+		std::vector<int> wordLetters;       ///< Letras (0..25) de la palabra en curso: descifradas o cifradas.
+		std::vector<bool> variable;         ///< La letra i cae en la columna que se est decidiendo.
+		WordLevels sampleWords;             ///< Palabras dentro de la muestra (se puntan en cada nodo).
+		WordLevels restWords;               ///< Resto del texto (solo para hojas admitidas).
+		std::vector<Gains> sampleGains;     ///< sampleGains[pos][s]: palabras que completa la letra s en pos.
+		std::vector<Gains> restGains;       ///< Igual para restWords; vlidas hasta restGainsValid.
+		std::vector<double> samplePartial;  ///< samplePartial[pos] = palabras completas por las columnas < pos.
+		std::vector<double> restPartial;    ///< Igual para restWords; vlido hasta restValid.
+		std::vector<double> sampleBestFrom; ///< sampleBestFrom[pos] = suma de sampleWords.best desde pos.
+		double restBest = 0.0;              ///< Suma de restWords.best (cota del resto del texto).
+		int restGainsValid = 0;
+		int restValid = 0;
+
+		/**
+		 * @brief Localiza las palabras candidatas (el descifrado no mueve espacios ni cambia maysculas).
+		 */
+		void findWords() {
+			size_t j = 0;
+			while (j < letters.size()) {
+				size_t end = j + 1;
+				while (end < letters.size() && letters[end] == letters[end - 1] + 1) ++end;
+
+				const size_t first = letters[j];
+				const size_t after = letters[end - 1] + 1;
+				bool upper = first > 0 && text[first - 1] == ' ' && after < text.size() && text[after] == ' ';
+				for (size_t i = first; upper && i < after; ++i) {
+					upper = text[i] >= 'A' && text[i] <= 'Z';
+				}
+				if (upper) {
+					Word word;
+					word.letter = j;
+					word.length = end - j;
+					(after < sampleLength ? sampleWords : restWords).all.push_back(word);
+				}
+				j = end;
+			}
+		}
+
+		static size_t completedBy(const Word& word, size_t L) {
+			const size_t last = word.letter % L + word.length - 1;
+			return last < L ? last : L - 1;
+		}
+
+		void groupWords(WordLevels& levels, size_t L) const {
+			levels.start.assign(L + 1, 0);
+			levels.byLevel.clear();
+			for (const Word& word : levels.all) {
+				if (word.length < dictionary.size() && !dictionary[word.length].empty()) {
+					levels.start[completedBy(word, L) + 1]++;
 				}
-				return;
 			}
-			for (char c = 'A'; c <= 'Z'; ++c) {
-				trailKey[pos] = c;
-				dfs(pos + 1, maxLen);
+			for (size_t k = 0; k < L; ++k) levels.start[k + 1] += levels.start[k];
+			levels.byLevel.resize(levels.start[L]);
+			std::vector<size_t> next(levels.start.begin(), levels.start.end() - 1);
+			for (const Word& word : levels.all) {
+				if (word.length < dictionary.size() && !dictionary[word.length].empty()) {
+					levels.byLevel[next[completedBy(word, L)]++] = word;
+				}
 			}
-			};
 
-		for (int L = 1; L <= maxKeyLenght; ++L) {
-			trailKey.assign(L, 'A');
-			dfs(0, L);
+			levels.best.assign(L, 0.0);
+			for (size_t k = 0; k < L; ++k) {
+				for (size_t w = levels.start[k]; w < levels.start[k + 1]; ++w) {
+					const Word& word = levels.byLevel[w];
+					if (canMatch(word, L)) levels.best[k] += static_cast<double>(word.length + 2);
+				}
+			}
 		}
 
-		std::cout << "*** Fuerza Bruta Vigenre ***\n";
-		std::cout << "Clave encontrada:  " << bestKey << "\n";
-		std::cout << "Texto descifrado:  " << bestText << "\n\n";
-		return bestKey;
-	}
+		/**
+		 * @brief true si alguna clave de longitud L convierte la palabra en una del diccionario.
+		 *
+		 * Las letras de una misma columna comparten desplazamiento, as que solo sirven
+		 * las palabras del diccionario que difieren del cifrado en la misma cantidad en
+		 * las posiciones i e i + L.
+		 */
+		bool canMatch(const Word& word, size_t L) const {
+			for (const std::string& candidate : dictionary[word.length]) {
+				size_t i = L;
+				for (; i < word.length; ++i) {
+					const int a = text[letters[word.letter + i]] - candidate[i];
+					const int b = text[letters[word.letter + i - L]] - candidate[i - L];
+					if ((a - b + 52) % 26 != 0) break;
+				}
+				if (i >= word.length) return true;
+			}
+			return false;
+		}
 
-private:
-	std::string key; // The key for the Vigenere cipher
-};
+		/**
+		 * @brief Punta para las 26 letras de la columna pos las palabras que esa columna completa.
+		 *
+		 * Las letras de las columnas anteriores ya estn fijadas por trailKey; cada letra
+		 * de la columna pos exige un desplazamiento concreto para coincidir con una
+		 * palabra del diccionario, as que basta con recorrer las palabras de esa longitud.
+		 */
+		void levelGains(const WordLevels& levels, int pos, int L, Gains& gains) {
+			gains.fill(0.0);
+			for (size_t w = levels.start[pos]; w < levels.start[pos + 1]; ++w) {
+				const Word& word = levels.byLevel[w];
+				int k = static_cast<int>(word.letter % L);
+				for (size_t i = 0; i < word.length; ++i) {
+					const int c = text[letters[word.letter + i]] - 'A';
+					variable[i] = k == pos;
+					wordLetters[i] = variable[i] ? c : (c + 26 - (trailKey[k] - 'A')) % 26;
+					if (++k == L) k = 0;
+				}
+				for (const std::string& candidate : dictionary[word.length]) {
+					int shift = -1;
+					size_t i = 0;
+					for (; i < word.length; ++i) {
+						const int target = candidate[i] - 'A';
+						if (!variable[i]) {
+							if (wordLetters[i] != target) break;
+						}
+						else {
+							const int needed = (wordLetters[i] + 26 - target) % 26;
+							if (shift < 0) shift = needed;
+							else if (needed != shift) break;
+						}
+					}
+					if (i == word.length) gains[shift] += static_cast<double>(word.length + 2);
+				}
+			}
+		}
 
+		void exhaustive(int L) {
+			columns.reshape(letterText, static_cast<size_t>(L));
+			buildColumnVariants(columns, variants, columnStart);
+			prepareLevel(L);
+			columnCount.resize(L);
+			for (int k = 0; k < L; ++k) {
+				columnCount[k] = (columnStart[k + 1] - columnStart[k]) / 26;
+			}
+			groupWords(sampleWords, static_cast<size_t>(L));
+			groupWords(restWords, static_cast<size_t>(L));
+			sampleGains.resize(L);
+			restGains.resize(L);
+			samplePartial.assign(L + 1, 0.0);
+			restPartial.assign(L + 1, 0.0);
+			restGainsValid = 0;
+			restValid = 0;
+			sampleBestFrom.assign(L + 1, 0.0);
+			for (int k = L - 1; k >= 0; --k) sampleBestFrom[k] = sampleBestFrom[k + 1] + sampleWords.best[k];
+			restBest = 0.0;
+			for (int k = 0; k < L; ++k) restBest += restWords.best[k];
+			exhaustiveNode(0, L);
+		}
 
-#include <iostream>
-#include <string>
-#include <vector>
-#include <cctype>
+		void exhaustiveNode(int pos, int L) {
+			if (stopped()) return;
+			result.stats.nodesVisited++;
+			if (pos == L) {
+				scoreLeaf(L);
+				doneLeaves += 1.0;
+				return;
+			}
+			// Las palabras de la muestra que completa esta columna se puntan una vez para
+			// las 26 letras; las del resto del texto, solo si alguna hoja pasa el filtro.
+			levelGains(sampleWords, pos, L, sampleGains[pos]);
+			for (int shift = 0; shift < 26 && !stopped(); ++shift) {
+				trailKey[pos] = static_cast<char>('A' + shift);
+				samplePartial[pos + 1] = samplePartial[pos] + sampleGains[pos][shift];
+				if (restGainsValid > pos + 1) restGainsValid = pos + 1;
+				if (restValid > pos) restValid = pos;
+
+				// Cota optimista: lo decidido ms lo mximo que pueden aportar las palabras
+				// pendientes. Ninguna hoja del subrbol supera esa suma.
+				const double bound = samplePartial[pos + 1] + sampleBestFrom[pos + 1] + restBest;
+				if (bound <= result.score) {
+					result.stats.nodesPruned++;
+					doneLeaves += subtreeLeaves[pos + 1];
+				}
+				else {
+					exhaustiveNode(pos + 1, L);
+				}
+				if (pos < 2) report(doneLeaves / totalLeaves);
+			}
+		}
+
+		/**
+		 * @brief Punta una hoja a partir de las sumas por columna.
+		 *
+		 * La suma de palabras no aplica la regla de no solapar dos apariciones seguidas
+		 * del mismo patrn (" DE DE "), as que nunca queda por debajo de fitness(): si
+		 * no supera a la mejor clave, la hoja no puede ganar y no se descifra.
+		 */
+		void scoreLeaf(int L) {
+			if (sampleLength < text.size() && !filter.admit(samplePartial[L])) return;
+			for (; restValid < L; ++restValid) {
+				if (restGainsValid <= restValid) {
+					levelGains(restWords, restValid, L, restGains[restValid]);
+					restGainsValid = restValid + 1;
+				}
+				restPartial[restValid + 1] = restPartial[restValid] + restGains[restValid][trailKey[restValid] - 'A'];
+			}
+			if (samplePartial[L] + restPartial[L] <= result.score) return;
+
+			for (int k = 0; k < L; ++k) {
+				const size_t count = columnCount[k];
+				const char* column = &variants[0] + columnStart[k] + (trailKey[k] - 'A') * count;
+				for (size_t t = 0; t < count; ++t) {
+					decodedText[letters[k + t * L]] = column[t];
+				}
+			}
+			result.stats.fullScores++;
+			consider(trailKey, decodedText, Vigenere::fitness(decodedText));
+		}
 
-std::string bestKey;
-std::string bestText;
-double bestScore = 0;
-std::string trailKey;
+		std::vector<double> scores;
+		std::vector<double> remainingMax;
+		std::vector<std::array<uint8_t, 26>> order;
+		std::string levelKey;
+		double levelBest = 0.0;
+
+		void branchAndBound(int L) {
+			columns.reshape(letterText, static_cast<size_t>(L));
+			columnScores(columns, scores);
+			prepareLevel(L);
+
+			order.resize(L);
+			remainingMax.assign(L + 1, 0.0);
+			for (int k = L - 1; k >= 0; --k) {
+				for (int s = 0; s < 26; ++s) order[k][s] = static_cast<uint8_t>(s);
+				const double* column = &scores[k * 26];
+				std::stable_sort(order[k].begin(), order[k].end(),
+					[column](uint8_t a, uint8_t b) { return column[a] > column[b]; });
+				remainingMax[k] = remainingMax[k + 1] + column[order[k][0]];
+			}
 
-// Evala qu tan bueno es el texto decodificado comparando palabras comunes
-double fitness(const std::string& decodedText) {
-	std::vector<std::string> palabrasClave = { "EL", "LA", "DE", "QUE", "Y", "EN", "UN", "SER", "ES", "CON" };
-	int score = 0;
+			levelKey.clear();
+			levelBest = -std::numeric_limits<double>::infinity();
+			boundNode(0, L, 0.0);
+			if (levelKey.empty()) return;
 
-	std::string palabraActual;
-	for (char c : decodedText) {
-		if (std::isalpha(c)) {
-			palabraActual += std::toupper(c);
+			std::string decoded = Vigenere(levelKey).decode(text);
+			consider(levelKey, decoded, Vigenere::fitness(decoded));
 		}
-		else {
-			if (!palabraActual.empty()) {
-				for (const auto& palabra : palabrasClave) {
-					if (palabraActual == palabra) score++;
+
+		void boundNode(int pos, int L, double partial) {
+			if (stopped()) return;
+			result.stats.nodesVisited++;
+			if (pos == L) {
+				if (partial > levelBest) {
+					levelBest = partial;
+					levelKey = trailKey;
+				}
+				doneLeaves += 1.0;
+				return;
+			}
+			// Hijos en orden de mejor a peor columna: la primera hoja ya es buena
+			// y las cotas de los hermanos siguientes se podan antes.
+			for (int rank = 0; rank < 26 && !stopped(); ++rank) {
+				int shift = order[pos][rank];
+				double value = partial + scores[pos * 26 + shift];
+				if (value + remainingMax[pos + 1] <= levelBest) {
+					// Los hermanos restantes tienen columnas an peores.
+					result.stats.nodesPruned += 26 - rank;
+					doneLeaves += (26 - rank) * subtreeLeaves[pos + 1];
+					break;
 				}
-				palabraActual.clear();
+				trailKey[pos] = static_cast<char>('A' + shift);
+				boundNode(pos + 1, L, value);
+			}
+			if (pos < 2) report(doneLeaves / totalLeaves);
+		}
+	};
+
+	/**
+	 * @brief Log-verosimilitud de cada columna descifrada con cada letra de clave.
+	 *
+	 * scores[k * 26 + s] = suma sobre las letras de la columna k de log P(letra - s),
+	 * con P las frecuencias de letras del espaol. Un histograma por columna basta:
+	 * O(N + 26 * 26 * L) en total.
+	 */
+	static void columnScores(const ColumnLayout& columns, std::vector<double>& scores) {
+		// Frecuencias aproximadas (%) de A..Z en espaol, sin .
+		static const double kSpanishFreq[26] = {
+			11.525, 2.215, 4.019, 5.010, 12.181, 0.692, 1.768, 0.703, 6.247,
+			0.493, 0.011, 4.967, 3.157, 6.712, 8.683, 2.510, 0.877, 6.871,
+			7.977, 4.632, 2.927, 1.138, 0.017, 0.215, 1.008, 0.467
+		};
+		static const std::array<double, 26> logFreq = [] {
+			std::array<double, 26> table{};
+			for (int c = 0; c < 26; ++c) table[c] = std::log(kSpanishFreq[c] / 100.0);
+			return table;
+		}();
+
+		const size_t L = columns.period();
+		std::vector<uint32_t> histogram(L * 26, 0);
+		uint32_t counts[256];
+		for (size_t k = 0; k < L; ++k) {
+			columns.histogram(k, counts);
+			for (int c = 0; c < 26; ++c) {
+				histogram[k * 26 + c] = counts['A' + c] + counts['a' + c];
 			}
 		}
-	}
 
-	return static_cast<double>(score);
-}
+		scores.assign(L * 26, 0.0);
+		for (size_t k = 0; k < L; ++k) {
+			for (int s = 0; s < 26; ++s) {
+				double sum = 0.0;
+				for (int c = 0; c < 26; ++c) {
+					sum += histogram[k * 26 + c] * logFreq[(c - s + 26) % 26];
+				}
+				scores[k * 26 + s] = sum;
+			}
+		}
+	}
 
-// DFS recursivo para generar claves y probarlas
-void dfs(int pos, int maxLen, const std::string& text) {
-	if (pos == maxLen) {
-		Vigenere v(trailKey);
-		std::string decodedText = v.decode(text);
-		double score = fitness(decodedText);
-		if (score > bestScore) {
-			bestScore = score;
-			bestKey = trailKey;
-			bestText = decodedText;
+	/**
+	 * @brief Precalcula las 26 versiones descifradas de cada columna para una longitud de clave.
+	 *
+	 * La columna k agrupa las letras k, k+L, k+2L... del texto. Su variante s (letra de
+	 * clave 'A'+s) queda en variants[columnStart[k] + s * n_k ...], con n_k letras por
+	 * variante, de modo que elegir una letra de la clave solo copia n_k caracteres.
+	 */
+	static void buildColumnVariants(const ColumnLayout& columns,
+		std::vector<char>& variants, std::vector<size_t>& columnStart) {
+		const size_t L = columns.period();
+		variants.resize(columns.size() * 26 + 1);
+		columnStart.assign(L + 1, 0);
+
+		for (size_t k = 0; k < L; ++k) {
+			const uint8_t* column = columns.column(k);
+			const size_t count = columns.columnSize(k);
+			columnStart[k + 1] = columnStart[k] + count * 26;
+
+			// Columna contigua: cada variante es un bucle de paso unitario.
+			for (int shift = 0; shift < 26; ++shift) {
+				char* out = &variants[0] + columnStart[k] + shift * count;
+				for (size_t t = 0; t < count; ++t) {
+					unsigned int c = column[t];
+					unsigned int base = c & 0x20u ? 'a' : 'A';
+					unsigned int value = c - base + 26u - static_cast<unsigned int>(shift);
+					out[t] = static_cast<char>((value >= 26u ? value - 26u : value) + base);
+				}
+			}
 		}
-		return;
 	}
 
-	for (char c = 'A'; c <= 'Z'; ++c) {
-		trailKey[pos] = c;
-		dfs(pos + 1, maxLen, text);
+	int maxKeyLength;               ///< Longitud mxima de clave a probar.
+	Strategy strategy;              ///< Estrategia de bsqueda.
+	ProgressCallback progress;      ///< Callback de progreso (opcional).
+	CancellationToken cancellation; ///< Token consultado en cada nodo.
+	CandidateFilter filter;         ///< Filtro de dos etapas (plantilla copiada en cada run()).
+};
+
+inline std::string Vigenere::breakEncode(const std::string& text, int maxKeyLenght,
+	SearchStats* stats, const CandidateFilter* filter) {
+	VigenereBreaker breaker(maxKeyLenght);
+	if (filter) breaker.setCandidateFilter(*filter);
+	VigenereBreaker::Result result = breaker.run(text);
+
+	std::cout << "*** Fuerza Bruta Vigenre ***\n";
+	std::cout << "Clave encontrada:  " << result.key << "\n";
+	std::cout << "Texto descifrado:  " << result.text << "\n";
+	if (stats) {
+		stats->nodesVisited += result.stats.nodesVisited;
+		stats->nodesPruned += result.stats.nodesPruned;
+		stats->fullScores += result.stats.fullScores;
+		std::cout << "Nodos visitados:   " << stats->nodesVisited << "\n";
+		std::cout << "Nodos podados:     " << stats->nodesPruned << "\n";
 	}
+	std::cout << "\n";
+	return result.key;
 }
 
-// Funcin principal para romper Vigenere
-std::string breakBruteForce(const std::string& text, int maxKeyLength = 3) {
-	bestKey.clear();
-	bestText.clear();
-	bestScore = 0;
-
-	for (int L = 1; L <= maxKeyLength; ++L) {
-		trailKey.assign(L, 'A');
-		dfs(0, L, text);
+inline std::string Vigenere::breakEncodeBranchAndBound(const std::string& text, int maxKeyLenght,
+	SearchStats* stats) {
+	VigenereBreaker breaker(maxKeyLenght, VigenereBreaker::Strategy::BranchAndBound);
+	VigenereBreaker::Result result = breaker.run(text);
+
+	std::cout << "*** Ramificacin y poda Vigenre ***\n";
+	std::cout << "Clave encontrada:  " << result.key << "\n";
+	std::cout << "Texto descifrado:  " << result.text << "\n";
+	if (stats) {
+		stats->nodesVisited += result.stats.nodesVisited;
+		stats->nodesPruned += result.stats.nodesPruned;
+		std::cout << "Nodos visitados:   " << stats->nodesVisited << "\n";
+		std::cout << "Nodos podados:     " << stats->nodesPruned << "\n";
 	}
+	std::cout << "\n";
+	return result.key;
+}
+
+// Funcin principal para romper Vigenere (fuerza bruta exhaustiva, sin estado global)
+inline std::string breakBruteForce(const std::string& text, int maxKeyLength = 3) {
+	VigenereBreaker::Result result = VigenereBreaker(maxKeyLength).run(text);
 
 	std::cout << "\n*** Fuerza Bruta Vigenre ***\n";
-	std::cout << "Clave encontrada : " << bestKey << "\n";
-	std::cout << "Texto descifrado : " << bestText << "\n\n";
+	std::cout << "Clave encontrada : " << result.key << "\n";
+	std::cout << "Texto descifrado : " << result.text << "\n\n";
 
-	return bestKey;
-}
\ No newline at end of file
+	return result.key;
+}
@@ -0,0 +1,216 @@
+﻿#pragma once
+#include "Prerequisites.h"
+#include "QuadgramTable.h"
+#include "NgramScorer.h"
+#include "Vigenere.h"
+
+/**
+ * @class VigenereQuadgramSolver
+ * @brief Rompe Vigenère con recocido simulado puntuado por cuatrigramas.
+ *
+ * Pensado para textos cortos con claves largas, donde el chi-cuadrado por columna
+ * no tiene suficientes letras. Parte de claves aleatorias y cambia una letra de la
+ * clave por iteración; NgramScorer solo vuelve a puntuar los cuatrigramas que
+ * tocan la columna modificada (O(N/L)), sin descifrar el texto completo. Varios reinicios
+ * aleatorios corren en paralelo y se devuelve el mejor.
+ */
+class VigenereQuadgramSolver {
+public:
+    /**
+     * @brief Parámetros de la búsqueda.
+     */
+    struct Options {
+        unsigned int restarts = 16;         ///< Reinicios aleatorios independientes.
+        unsigned int iterations = 20000;    ///< Cambios de letra probados por reinicio.
+        unsigned int threads = 0;           ///< Hilos de trabajo (0 = núcleos disponibles).
+        double startTemperature = 0.2;      ///< Temperatura inicial (por cuatrigrama afectado).
+        uint64_t seed = 0;                  ///< Semilla (0 = std::random_device).
+    };
+
+    /**
+     * @brief Resultado de la búsqueda.
+     */
+    struct Result {
+        std::string key;    ///< Mejor clave encontrada.
+        std::string text;   ///< Texto descifrado con esa clave.
+        double score = -std::numeric_limits<double>::infinity();  ///< Puntuación de cuatrigramas.
+    };
+
+    /**
+     * @param table Tabla de cuatrigramas ya cargada (debe vivir mientras se use el solver).
+     */
+    explicit VigenereQuadgramSolver(const QuadgramTable& table) : m_table(table) {}
+
+    ~VigenereQuadgramSolver() = default;
+
+    /**
+     * @brief Busca la clave de longitud dada que maximiza la puntuación de cuatrigramas.
+     *
+     * @param text Texto cifrado.
+     * @param keyLength Longitud de la clave (p. ej. estimada por índice de coincidencia).
+     * @param options Parámetros de la búsqueda.
+     * @return Result Mejor clave, texto descifrado y puntuación.
+     * @throws std::invalid_argument Si la tabla no está cargada o keyLength es 0.
+     */
+    Result solve(const std::string& text, unsigned int keyLength, const Options& options) const {
+        if (!m_table.loaded()) {
+            throw std::invalid_argument("La tabla de cuatrigramas no está cargada.");
+        }
+        if (keyLength == 0) {
+            throw std::invalid_argument("La longitud de clave debe ser mayor que 0.");
+        }
+
+        std::vector<uint8_t> cipher;
+        cipher.reserve(text.size());
+        for (char ch : text) {
+            unsigned int folded = static_cast<unsigned char>(ch) | 0x20u;
+            if (folded - 'a' < 26u) cipher.push_back(static_cast<uint8_t>(folded - 'a'));
+        }
+
+        uint64_t seed = options.seed;
+        if (seed == 0) {
+            std::random_device rd;
+            seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+        }
+
+        unsigned int threads = options.threads;
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min(threads, std::max(1u, options.restarts));
+
+        // Cada hilo toma reinicios de un contador compartido; la semilla depende solo
+        // del número de reinicio, así que el resultado no depende del reparto.
+        std::atomic<unsigned int> nextRestart(0);
+        std::vector<Result> best(threads);
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                Climber climber(m_table, cipher, keyLength);
+                unsigned int r;
+                while ((r = nextRestart.fetch_add(1)) < options.restarts) {
+                    climber.run(seed + r, options.iterations, options.startTemperature);
+                    if (climber.bestScore > best[t].score) {
+                        best[t].score = climber.bestScore;
+                        best[t].key = climber.bestKey;
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+
+        Result result;
+        for (const auto& candidate : best) {
+            if (candidate.score > result.score) result = candidate;
+        }
+        if (!result.key.empty()) {
+            result.text = Vigenere(result.key).decode(text);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Igual que solve(text, keyLength, options) con los parámetros por defecto.
+     */
+    Result solve(const std::string& text, unsigned int keyLength) const {
+        return solve(text, keyLength, Options());
+    }
+
+private:
+    /**
+     * @brief Estado de un reinicio: clave y texto claro puntuado de forma incremental.
+     */
+    struct Climber {
+        Climber(const QuadgramTable& table, const std::vector<uint8_t>& cipher, unsigned int keyLength)
+            : cipher(cipher), length(keyLength), key(keyLength),
+            scorer(table.data(), 26, 4) {}
+
+        const std::vector<uint8_t>& cipher;
+        const size_t length;
+        std::vector<uint8_t> key;
+        NgramScorer scorer;             ///< Texto claro actual y su puntuación.
+        std::vector<uint8_t> column;    ///< Columna descifrada con la letra candidata.
+        std::string bestKey;
+        double bestScore = -std::numeric_limits<double>::infinity();
+
+        /**
+         * @brief Cambia la letra k de la clave; solo se vuelven a puntuar los
+         * cuatrigramas que tocan la columna k.
+         * @return double Cambio de la puntuación.
+         */
+        double setKey(size_t k, uint8_t shift) {
+            column.clear();
+            for (size_t j = k; j < cipher.size(); j += length) {
+                unsigned int value = cipher[j] + 26u - shift;
+                column.push_back(static_cast<uint8_t>(value >= 26 ? value - 26 : value));
+            }
+            key[k] = shift;
+            return scorer.updateColumn(k, length, column.data());
+        }
+
+        void run(uint64_t seed, unsigned int iterations, double startTemperature) {
+            std::mt19937_64 rng(seed);
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            for (size_t k = 0; k < length; ++k) key[k] = static_cast<uint8_t>(rng() % 26);
+
+            std::vector<uint8_t> plain(cipher.size());
+            for (size_t j = 0; j < cipher.size(); ++j) {
+                unsigned int value = cipher[j] + 26u - key[j % length];
+                plain[j] = static_cast<uint8_t>(value >= 26 ? value - 26 : value);
+            }
+            scorer.reset(plain.data(), plain.size());
+
+            // Normaliza la temperatura por los cuatrigramas que toca una columna.
+            const double perColumn = std::max<double>(1.0,
+                length < 4 ? plain.size() : 4.0 * plain.size() / length);
+
+            for (unsigned int it = 0; it < iterations; ++it) {
+                double temperature = startTemperature * (1.0 - static_cast<double>(it) / iterations);
+                size_t k = rng() % length;
+                uint8_t previous = key[k];
+                uint8_t candidate = static_cast<uint8_t>(rng() % 25);
+                if (candidate >= previous) candidate++;
+
+                double delta = setKey(k, candidate);
+                if (!(delta >= 0 || (temperature > 0 &&
+                    unit(rng) < std::exp(delta / (perColumn * temperature))))) {
+                    scorer.undo();
+                    key[k] = previous;
+                }
+            }
+
+            // Ascenso final: cada columna toma su mejor letra hasta que nada mejora.
+            bool improved = true;
+            while (improved) {
+                improved = false;
+                for (size_t k = 0; k < length; ++k) {
+                    uint8_t current = key[k];
+                    double bestDelta = 0.0;
+                    uint8_t bestShift = current;
+                    for (uint8_t shift = 0; shift < 26; ++shift) {
+                        if (shift == current) continue;
+                        double delta = setKey(k, shift);
+                        scorer.undo();
+                        if (delta > bestDelta + 1e-9) {
+                            bestDelta = delta;
+                            bestShift = shift;
+                        }
+                    }
+                    key[k] = current;
+                    if (bestShift != current) {
+                        setKey(k, bestShift);
+                        improved = true;
+                    }
+                }
+            }
+
+            // Recalcula desde cero para no arrastrar el error acumulado de los deltas.
+            double score = scorer.rescore();
+            if (score > bestScore) {
+                bestScore = score;
+                bestKey.resize(length);
+                for (size_t k = 0; k < length; ++k) bestKey[k] = static_cast<char>('A' + key[k]);
+            }
+        }
+    };
+
+    const QuadgramTable& m_table;  ///< Tabla compartida (solo lectura entre hilos).
+};
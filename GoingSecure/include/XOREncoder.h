@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include "Prerequisites.h"
+#include "CandidateFilter.h"
+#include "ColumnLayout.h"
 
 /**
  * @class XOREncoder
@@ -48,6 +50,31 @@ public:
         return output;
     }
 
+    /**
+     * @brief Aplica XOR a un trozo de datos continuando la posición de la clave.
+     *
+     * Permite procesar archivos por bloques: encadenar las llamadas pasando la fase
+     * devuelta da el mismo resultado que encode() sobre todo el contenido.
+     *
+     * @param input Bytes de entrada.
+     * @param length Número de bytes.
+     * @param output Destino (puede ser el mismo que input).
+     * @param key Clave de cifrado.
+     * @param phase Posición de la clave para el primer byte.
+     * @return size_t Posición de la clave para el byte siguiente al trozo.
+     * @throws std::invalid_argument Si la clave está vacía.
+     */
+    size_t encode(const char* input, size_t length, char* output, const std::string& key, size_t phase) {
+        if (key.empty()) {
+            throw std::invalid_argument("La clave XOR no puede estar vacía.");
+        }
+        for (size_t i = 0; i < length; i++) {
+            output[i] = input[i] ^ key[phase];
+            if (++phase == key.size()) phase = 0;
+        }
+        return phase;
+    }
+
     /**
      * @brief Convierte una cadena hexadecimal a un vector de bytes.
      *
@@ -120,7 +147,12 @@ public:
      * Ideal para ejercicios de concienciación sobre seguridad en videojuegos.
      */
     void bruteForce_1Byte(const std::vector<unsigned char>& cifrado) {
+        ColumnLayout columnas;
+        columnas.reshape(cifrado.data(), cifrado.size(), 1);
+        const std::array<bool, 256> validas = clavesLegibles(columnas, 0);
+
         for (int clave = 0; clave < 256; ++clave) {
+            if (!validas[clave]) continue;
             std::string result;
             for (unsigned char c : cifrado) {
                 result += static_cast<unsigned char>(c ^ clave);
@@ -142,11 +174,22 @@ public:
      * Prueba todas las combinaciones posibles de dos bytes (65536 claves)
      * y muestra las que generan resultados legibles.
      *
+     * Cada byte de la clave solo afecta a su columna (posiciones pares o impares),
+     * así que primero se calculan, columna por columna, los bytes que la dejan
+     * legible; solo se descifran los pares formados por bytes válidos en ambas.
+     *
      * @param cifrado Vector de bytes cifrados.
      */
     void bruteForce_2Byte(const std::vector<unsigned char>& cifrado) {
+        ColumnLayout columnas;
+        columnas.reshape(cifrado.data(), cifrado.size(), 2);
+        const std::array<bool, 256> validas1 = clavesLegibles(columnas, 0);
+        const std::array<bool, 256> validas2 = clavesLegibles(columnas, 1);
+
         for (int b1 = 0; b1 < 256; ++b1) {
+            if (!validas1[b1]) continue;
             for (int b2 = 0; b2 < 256; ++b2) {
+                if (!validas2[b2]) continue;
                 std::string result;
                 unsigned char key[2] = {
                   static_cast<unsigned char>(b1),
@@ -176,24 +219,50 @@ public:
      * Usa una lista de claves débiles o populares para intentar decodificar
      * el texto cifrado. Se muestran los resultados válidos.
      *
+     * Con un filtro activo, cada clave descifra primero solo la muestra inicial y la
+     * puntúa por proporción de bytes imprimibles; únicamente las claves cercanas a la
+     * mejor muestra descifran el resto y pasan por isValidText().
+     *
      * @param cifrado Vector de bytes cifrados.
+     * @param filtro Filtro de dos etapas opcional (nullptr = descifrar con todas las claves).
+     *               Cada llamada trabaja con su propia copia, así que la mejor muestra
+     *               de un texto no se arrastra al siguiente.
      *
      * @note Práctica útil para demostrar la importancia de no usar contraseñas
      * predecibles en configuraciones o archivos internos de juegos.
      */
-    void bruteForceByDictionary(const std::vector<unsigned char>& cifrado) {
+    void bruteForceByDictionary(const std::vector<unsigned char>& cifrado,
+        const CandidateFilter* filtro = nullptr) {
         std::vector<std::string> clavesComunes = {
           "clave", "admin", "1234", "root", "test", "abc", "hola", "user",
           "pass", "12345", "0000", "password", "default"
         };
 
+        CandidateFilter etapas = filtro != nullptr ? *filtro : CandidateFilter();
+        etapas.reset();
+        const size_t muestra = etapas.sampleLength(cifrado.size());
+        const bool dosEtapas = muestra < cifrado.size();
+
         for (const auto& clave : clavesComunes) {
             std::string result;
-            for (int i = 0; i < cifrado.size(); i++) {
+            result.reserve(cifrado.size());
+            for (size_t i = 0; i < muestra; i++) {
                 result += static_cast<unsigned char>(
                     cifrado[i] ^ clave[i % clave.size()]);
             }
 
+            if (dosEtapas) {
+                size_t imprimibles = std::count_if(result.begin(), result.end(), [](unsigned char c) {
+                    return std::isprint(c) || std::isspace(c);
+                    });
+                if (!etapas.admit(static_cast<double>(imprimibles) / muestra)) continue;
+
+                for (size_t i = muestra; i < cifrado.size(); i++) {
+                    result += static_cast<unsigned char>(
+                        cifrado[i] ^ clave[i % clave.size()]);
+                }
+            }
+
             if (isValidText(result)) {
                 std::cout << "=============================\n";
                 std::cout << "Clave de diccionario: '" << clave << "'\n";
@@ -203,5 +272,27 @@ public:
     }
 
 private:
-    // No se requiere almacenamiento interno en esta versión.
+    /**
+     * @brief Bytes de clave que dejan legible toda la columna k (mismo criterio que isValidText).
+     *
+     * Usa el histograma de la columna: cada byte distinto se comprueba una vez por clave.
+     */
+    static std::array<bool, 256> clavesLegibles(const ColumnLayout& columnas, size_t k) {
+        uint32_t cuentas[256];
+        columnas.histogram(k, cuentas);
+
+        std::vector<unsigned char> presentes;
+        for (int v = 0; v < 256; ++v) {
+            if (cuentas[v] != 0) presentes.push_back(static_cast<unsigned char>(v));
+        }
+
+        std::array<bool, 256> validas;
+        for (int clave = 0; clave < 256; ++clave) {
+            validas[clave] = std::all_of(presentes.begin(), presentes.end(), [clave](unsigned char v) {
+                unsigned char c = static_cast<unsigned char>(v ^ clave);
+                return std::isprint(c) || std::isspace(c);
+                });
+        }
+        return validas;
+    }
 };
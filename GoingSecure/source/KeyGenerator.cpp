@@ -1,26 +1,19 @@
 #include "../include/KeyGenerator.h"
 #include "../include/Prerequisites.h"
 #include "../include/utils.h"  // Necesario para usar stringToBitset
-#include <random>
+#include "../include/DesKeyFactory.h"
 #include <iostream>
 #include <iomanip>
 
 /**
  * @brief Genera una clave de 8 caracteres aleatorios (64 bits).
+ *
+ * Usa DesKeyFactory: bytes de RandomPool, paridad impar por byte y sin claves
+ * debiles ni semidebiles. Para muchas claves, DesKeyFactory::generate(out, count).
  * @return std::string Clave generada.
  */
 std::string generateRandomKey() {
-    std::string key;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(0, 255);
-
-    for (int i = 0; i < 8; ++i) {
-        char byte = static_cast<char>(dist(gen));
-        key += byte;
-    }
-
-    return key;
+    return DesKeyFactory::toString(DesKeyFactory::generate());
 }
 
 /**
@@ -7,6 +7,9 @@
  *  - Elegir una operación: cifrar o descifrar
  *  - Seleccionar un algoritmo: César, XOR, Vigenere, DES
  *  - Escribir una clave y procesar el archivo
+ *
+ * También genera la tabla de cuatrigramas que usa VigenereQuadgramSolver a partir
+ * de un corpus de texto en español.
  */
 
 #include "../include/Prerequisites.h"
@@ -14,6 +17,8 @@
 #include "../include/XOREncoder.h"
 #include "../include/Vigenere.h"
 #include "../include/DES.h"
+#include "../include/Base64.h"
+#include "../include/QuadgramTable.h"
 #include "../include/KeyGenerator.h"
 #include "../include/utils.h"
 
@@ -26,6 +31,7 @@
 #include <io.h>
 #include <direct.h>
 #include <cstdlib>
+#include <cstdio>
 
  // -------- FUNCIONES AUXILIARES --------
 std::vector<std::string> listarArchivos(const std::string& carpeta) {
@@ -68,12 +74,54 @@ std::string seleccionarArchivoDesdeCarpeta(const std::string& carpeta) {
 
 // -------- PROGRAMA PRINCIPAL --------
 void procesarArchivo();
+void generarTablaCuatrigramas();
 
 int main() {
-    procesarArchivo();
+    std::cout << "[1] Cifrar/Descifrar archivo  [2] Generar tabla de cuatrigramas: ";
+    int opcion = 1;
+    std::cin >> opcion;
+    std::cin.ignore();
+
+    if (opcion == 2) {
+        generarTablaCuatrigramas();
+    }
+    else {
+        procesarArchivo();
+    }
     return 0;
 }
 
+// Cuenta los cuatrigramas de un corpus (.txt en DatosCrudos) y guarda la tabla
+// binaria que luego carga QuadgramTable::load().
+void generarTablaCuatrigramas() {
+    std::cout << "\n--- Tabla de cuatrigramas ---\n";
+
+    std::string rutaCorpus = seleccionarArchivoDesdeCarpeta("DatosCrudos");
+    if (rutaCorpus.empty()) return;
+
+    std::ifstream corpusFile(rutaCorpus, std::ios::binary);
+    if (!corpusFile) {
+        std::cerr << "Error al abrir el corpus.\n";
+        return;
+    }
+    std::ostringstream oss;
+    oss << corpusFile.rdbuf();
+
+    _mkdir("DatosOut");
+    const std::string rutaTabla = "DatosOut\\cuatrigramas.bin";
+    try {
+        QuadgramTable tabla;
+        tabla.buildFromCorpus(oss.str());
+        tabla.save(rutaTabla);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error al generar la tabla: " << e.what() << "\n";
+        return;
+    }
+
+    std::cout << "Tabla guardada en: " << rutaTabla << "\n";
+}
+
 void procesarArchivo() {
     std::cout << "\n--- Cifrado/Descifrado de Archivos ---\n";
 
@@ -105,45 +153,46 @@ void procesarArchivo() {
         std::getline(std::cin, clave);
     }
 
+    // Base64 se aplica a la salida al cifrar y a la entrada al descifrar.
+    std::cout << "Formato del cifrado: [1] Binario  [2] Base64: ";
+    int formato;
+    std::cin >> formato;
+    std::cin.ignore();
+    bool salidaBase64 = (formato == 2 && operacion == 1);
+    bool entradaBase64 = (formato == 2 && operacion == 2);
+
+    if (algoritmo < 1 || algoritmo > 4) {
+        std::cerr << "Algoritmo no valido.\n";
+        return;
+    }
+
     std::ifstream inFile(rutaEntrada, std::ios::binary);
     if (!inFile) {
         std::cerr << "Error al abrir el archivo de entrada.\n";
         return;
     }
 
-    std::ostringstream oss;
-    oss << inFile.rdbuf();
-    std::string contenido = oss.str();
-    inFile.close();
-
-    std::string resultado;
-
-    switch (algoritmo) {
-    case 1: { // César
-        CesarEncryption cesar;
-        int rotacion = std::stoi(clave);
-        resultado = (operacion == 1)
-            ? cesar.encode(contenido, rotacion)
-            : cesar.decode(contenido, rotacion);
-        break;
-    }
-    case 2: { // XOR
-        XOREncoder xorEnc;
-        resultado = xorEnc.encode(contenido, clave);
-        break;
-    }
-    case 3: { // Vigenere
-        Vigenere vig(clave);
-        resultado = (operacion == 1)
-            ? vig.encode(contenido)
-            : vig.decode(contenido);
-        break;
-    }
-    case 4: { // DES
+    if (algoritmo == 4) { // DES
         if (clave.length() != 8) {
             std::cerr << "La clave DES debe tener 8 caracteres.\n";
             return;
         }
+        std::ostringstream oss;
+        oss << inFile.rdbuf();
+        std::string contenido = oss.str();
+        inFile.close();
+
+        if (entradaBase64) {
+            try {
+                std::vector<uint8_t> bytes = Base64::decode(contenido, Base64::Mode::IgnoreWhitespace);
+                contenido.assign(bytes.begin(), bytes.end());
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error al decodificar Base64: " << e.what() << "\n";
+                return;
+            }
+        }
+
         std::bitset<64> keyBits = stringToBitset(clave);
         DES des(keyBits);
 
@@ -154,21 +203,104 @@ void procesarArchivo() {
             ? des.encode(dataBits)
             : des.decode(dataBits);
 
-        resultado = bitsetToString(resultadoBits);
-        break;
-    }
-    default:
-        std::cerr << "Algoritmo no valido.\n";
+        std::string resultado = bitsetToString(resultadoBits);
+        if (salidaBase64) {
+            resultado = Base64::encode(reinterpret_cast<const uint8_t*>(resultado.data()), resultado.size());
+        }
+
+        std::ofstream outFile(rutaSalida, std::ios::binary);
+        if (!outFile) {
+            std::cerr << "Error al abrir el archivo de salida.\n";
+            return;
+        }
+        outFile << resultado;
+        outFile.close();
+
+        std::cout << "Operacion completada y archivo guardado en: " << rutaSalida << "\n";
         return;
     }
 
+    // Cesar, XOR y Vigenere se procesan por bloques en una sola pasada, con memoria
+    // constante sin importar el tamano del archivo.
     std::ofstream outFile(rutaSalida, std::ios::binary);
     if (!outFile) {
         std::cerr << "Error al abrir el archivo de salida.\n";
         return;
     }
 
-    outFile << resultado;
+    // Una clave o un Base64 invalidos se detectan a mitad del archivo: en ese caso se
+    // borra la salida parcial en lugar de dejarla truncada.
+    try {
+        CesarEncryption cesar;
+        int rotacion = (algoritmo == 1) ? std::stoi(clave) : 0;
+        XOREncoder xorEnc;
+        size_t faseXor = 0;
+        std::unique_ptr<VigenereStream> vig;
+        if (algoritmo == 3) {
+            vig = std::make_unique<VigenereStream>(clave, (operacion == 1)
+                ? VigenereStream::Mode::Encode
+                : VigenereStream::Mode::Decode);
+        }
+
+        Base64Encoder armadura;
+        Base64Decoder desarmadura(Base64::Mode::IgnoreWhitespace);
+        std::vector<char> bloque(64 * 1024);
+        std::vector<uint8_t> decodificado;
+        std::vector<char> texto;
+
+        while (inFile) {
+            inFile.read(bloque.data(), bloque.size());
+            size_t leidos = static_cast<size_t>(inFile.gcount());
+            if (leidos == 0) break;
+
+            std::string datos;
+            if (entradaBase64) {
+                decodificado.resize(Base64Decoder::maxOutput(leidos));
+                size_t n = desarmadura.update(bloque.data(), leidos, decodificado.data());
+                datos.assign(reinterpret_cast<const char*>(decodificado.data()), n);
+            }
+            else {
+                datos.assign(bloque.data(), leidos);
+            }
+
+            switch (algoritmo) {
+            case 1: // César (sin estado entre caracteres)
+                datos = (operacion == 1)
+                    ? cesar.encode(datos, rotacion)
+                    : cesar.decode(datos, rotacion);
+                break;
+            case 2: // XOR (conserva la posicion de la clave entre bloques)
+                faseXor = xorEnc.encode(datos.data(), datos.size(), &datos[0], clave, faseXor);
+                break;
+            case 3: // Vigenere (conserva la posicion de la clave entre bloques)
+                vig->process(datos.data(), datos.size(), &datos[0]);
+                break;
+            }
+
+            if (salidaBase64) {
+                texto.resize(Base64Encoder::maxOutput(datos.size()));
+                size_t n = armadura.update(reinterpret_cast<const uint8_t*>(datos.data()), datos.size(), texto.data());
+                outFile.write(texto.data(), n);
+            }
+            else {
+                outFile.write(datos.data(), datos.size());
+            }
+        }
+
+        if (salidaBase64) {
+            char cola[4];
+            outFile.write(cola, armadura.finish(cola));
+        }
+        if (entradaBase64) {
+            desarmadura.finish();
+        }
+    }
+    catch (const std::exception& e) {
+        outFile.close();
+        std::remove(rutaSalida.c_str());
+        std::cerr << "Error al procesar el archivo: " << e.what() << "\n";
+        return;
+    }
     outFile.close();
 
     std::cout << "Operacion completada y archivo guardado en: " << rutaSalida << "\n";